@@ -8,7 +8,12 @@
  * Interface for the REA* algorithm WASM implementation.
  */
 
-import { SquareGridMap, Point2 } from "../data/square-grid";
+import {
+    SquareGridMap,
+    Point2,
+    Rasterizable,
+    Costed
+} from "../data/square-grid";
 import { Colored } from '../data/graph';
 import { Deque } from "../util/deque";
 
@@ -26,10 +31,58 @@ declare namespace REAStarWASM
     class BooleanGrid implements Grid<boolean>
     {
         constructor(map: SquareGridMap & Colored<Point2, boolean>);
+        constructor(
+            map: SquareGridMap & Colored<Point2, boolean>,
+            buffer: Uint8Array
+        );
         at(p: Point2): boolean;
         set(p: Point2, value: boolean): void;
+        enterable(p: Point2): boolean;
+        walls(p: Point2): number;
+        setWalls(p: Point2, mask: number): void;
+        invalidate(left: number, top: number, right: number, bottom: number): void;
+        buildClearance(): void;
         get width(): number;
         get height(): number;
+        get loops(): boolean;
+        delete(): void;
+    }
+
+    class CostGrid implements Grid<number>
+    {
+        constructor(map: SquareGridMap, buffer: Uint8Array);
+        at(p: Point2): number;
+        set(p: Point2, value: number): void;
+        get width(): number;
+        get height(): number;
+        delete(): void;
+    }
+
+    class REAStarSearch
+    {
+        constructor();
+        begin(
+            source: Point2,
+            target: Point2,
+            grid: BooleanGrid,
+            maxlen: number
+        ): void;
+        step(maxExpansions: number): number;
+        stepFor(microseconds: number): number;
+        status(): number;
+        path(): number;
+        delete(): void;
+    }
+
+    class DistanceField
+    {
+        constructor();
+        path(
+            source: Point2,
+            target: Point2,
+            grid: BooleanGrid,
+            radius: number
+        ): number;
         delete(): void;
     }
 
@@ -38,9 +91,197 @@ declare namespace REAStarWASM
         target: Point2,
         grid: BooleanGrid,
         maxlen: number
-    ): { size(): number, get(i: number): Point2, delete(): void; };
+    ): number;
+
+    function rectangleExpansionAStarComplete(
+        source: Point2,
+        target: Point2,
+        grid: BooleanGrid,
+        maxlen: number
+    ): number;
+
+    function rectangleExpansionAStarGreedy(
+        source: Point2,
+        target: Point2,
+        grid: BooleanGrid,
+        maxlen: number
+    ): number;
+
+    function rectangleExpansionAStarNearest(
+        source: Point2,
+        targets: Int32Array,
+        grid: BooleanGrid,
+        maxlen: number
+    ): number;
+
+    function weightedRectangleExpansionAStar(
+        source: Point2,
+        target: Point2,
+        grid: CostGrid,
+        maxcost: number
+    ): number;
+
+    function hierarchicalAStar(
+        source: Point2,
+        target: Point2,
+        grid: BooleanGrid
+    ): number;
+
+    function jumpPointSearch(
+        source: Point2,
+        target: Point2,
+        grid: BooleanGrid,
+        maxlen: number
+    ): number;
+
+    function corridorRatio(grid: BooleanGrid): number;
+
+    function gridAStar(
+        source: Point2,
+        target: Point2,
+        grid: BooleanGrid,
+        maxlen: number
+    ): number;
+
+    function cachedPath(
+        source: Point2,
+        target: Point2,
+        grid: BooleanGrid,
+        maxlen: number
+    ): number;
+
+    function getLastSearchStats(): SearchStats | null;
+    function getSearchHistogram(grid: BooleanGrid): SearchHistogram;
+    function resetSearchHistogram(grid: BooleanGrid): void;
+
+    /**
+     * @returns a view over the path found by the last single search, as interleaved coordinates. It is
+     *          only valid until the next call into the module.
+     */
+    function pathBuffer(): Int32Array;
+
+    function rectangleExpansionAStarBatch(
+        queries: Int32Array,
+        grid: BooleanGrid
+    ): { points: Int32Array, offsets: Int32Array };
+
+    function rectangleExpansionAStarSubmit(
+        queries: Int32Array,
+        grid: BooleanGrid
+    ): void;
+
+    function rectangleExpansionAStarReady(): boolean;
+
+    function rectangleExpansionAStarCollect(): {
+        points: Int32Array,
+        offsets: Int32Array
+    };
+}
+
+/**
+ * Boolean grid on the WASM heap used as input for REA*.
+ * 
+ * Instances must be released with `delete()` once no longer needed.
+ */
+export type BooleanGrid = REAStarWASM.BooleanGrid;
+
+/**
+ * Interface for a map that owns a persistent grid to be used by REA*.
+ */
+export interface BooleanGridOwner
+{
+    /**
+     * @returns the grid for the map. Its lifetime is managed by the map.
+     */
+    booleanGrid(): BooleanGrid;
 }
 
+/**
+ * Map on which REA* can be applied.
+ */
+export type REAStarMap =
+    SquareGridMap & Colored<Point2, boolean> & Partial<BooleanGridOwner>;
+
+/**
+ * Cost grid on the WASM heap used as input for weighted REA*.
+ * 
+ * Instances must be released with `delete()` once no longer needed.
+ */
+export type CostGrid = REAStarWASM.CostGrid;
+
+/**
+ * Interface for a map that owns a persistent cost grid to be used by weighted
+ * REA*.
+ */
+export interface CostGridOwner
+{
+    /**
+     * @returns the cost grid for the map. Its lifetime is managed by the map.
+     */
+    costGrid(): CostGrid;
+}
+
+/**
+ * Map on which weighted REA* can be applied.
+ */
+export type WeightedREAStarMap =
+    SquareGridMap & Costed & Partial<CostGridOwner>;
+
+/**
+ * State of an incremental REA* search.
+ */
+export type SearchStatus = 'in-progress' | 'found' | 'failed';
+
+/**
+ * REA* solvers compiled into the module:
+ * 
+ * - `default`: float octile lengths, with diagonal steps of 1.414, partial
+ *   paths and a maximum length.
+ * - `complete`: only complete paths and no maximum length, otherwise the same
+ *   paths as `default`.
+ * - `greedy`: integer lengths and the Manhattan heuristic, which expands
+ *   fewer nodes at the cost of slightly longer paths.
+ */
+export type REAStarVariant = 'default' | 'complete' | 'greedy';
+
+/**
+ * Search states, indexed by their values on the WASM module.
+ */
+const SEARCH_STATUSES: SearchStatus[] = ['in-progress', 'found', 'failed'];
+
+/**
+ * Source, target and maximum length for a REA* search.
+ */
+export type PathQuery = { source: Point2, target: Point2, maxlen: number };
+
+/**
+ * Counters for a REA* search, collected on builds of the WASM module with
+ * `REA_STAR_STATS` defined.
+ */
+export type SearchStats = {
+    expansions: number,
+    merged: number,
+    pushes: number,
+    peakOpen: number,
+    subintervalScans: number,
+    probes: number,
+    fetches: number,
+    expandMicros: number,
+    successorMicros: number,
+    totalMicros: number
+};
+
+/**
+ * Number of REA* searches on a grid by expanded nodes and by microseconds, in
+ * power of two buckets (i.e. bucket `i` roughly covers values from `2^i` up to
+ * `2^(i + 1)`). The last bucket also takes every larger value.
+ */
+export type SearchHistogram = {
+    searches: number,
+    expansions: number[],
+    latency: number[]
+};
+
 declare const initREAStarWASM: () => Promise<typeof REAStarWASM>;
 
 /**
@@ -56,33 +297,809 @@ export async function init(): Promise<void>
     WASM = await initREAStarWASM();
 }
 
+/**
+ * Creates a grid for the REA* algorithm from a map.
+ * 
+ * @param map - colored map.
+ * 
+ * @returns a grid preloaded with the map colors, which refetches them from the
+ *          map when invalidated.
+ */
+export function createBooleanGrid(
+    map: SquareGridMap & Colored<Point2, boolean>
+): BooleanGrid
+{
+    if (!WASM) throw "REA* is uninitialized";
+
+    const grid = new WASM.BooleanGrid(map, passability(map));
+
+    // Drops the histogram of any grid previously at the same address.
+    WASM.resetSearchHistogram(grid);
+
+    return grid;
+}
+
 /**
  * Applies REA* to find the shortest path between two points on a map.
  * 
+ * If the map owns a persistent grid, it is used for the search. Otherwise, a
+ * temporary grid is created for it.
+ * 
  * @param source - starting point.
  * @param target - goal point.
  * @param map - colored map.
+ * @param variant - solver to use.
  */
 export function rectangleExpansionAStar(
     source: Point2,
     target: Point2,
-    map: SquareGridMap & Colored<Point2, boolean>,
+    map: REAStarMap,
+    maxlen: number,
+    variant: REAStarVariant = 'default'
+): Deque<Point2> | undefined
+{
+    return withGrid(map, grid => {
+        const search =
+            variant === 'complete' ? WASM.rectangleExpansionAStarComplete
+            : variant === 'greedy' ? WASM.rectangleExpansionAStarGreedy
+            : WASM.rectangleExpansionAStar;
+
+        const size = search(
+            source,
+            target,
+            grid,
+            Math.min(maxlen, 0x7fffffff)
+        );
+
+        return readPath(size);
+    });
+}
+
+/**
+ * Creates a cost grid for weighted REA* from a map.
+ * 
+ * @param map - map with movement costs.
+ * 
+ * @returns a grid with the costs of the map.
+ */
+export function createCostGrid(map: SquareGridMap & Costed): CostGrid
+{
+    if (!WASM) throw "REA* is uninitialized";
+
+    return new WASM.CostGrid(map, map.costs());
+}
+
+/**
+ * Applies REA* to find a cheap path between two points on a map with
+ * movement costs. It is not guaranteed to be the cheapest one, and may cost
+ * a few percent more.
+ * 
+ * Regions where every point has the same cost are crossed as quickly as open
+ * ground is by `rectangleExpansionAStar`, so maps with a few kinds of terrain
+ * (e.g. roads, grass and swamps) search about as fast as plain ones.
+ * 
+ * If the map owns a persistent cost grid, it is used for the search.
+ * Otherwise, a temporary grid is created for it.
+ * 
+ * @param source - starting point.
+ * @param target - goal point.
+ * @param map - map with movement costs.
+ * @param maxcost - maximum cost of the path.
+ * 
+ * @returns the path, or the path to the closest point found if the target
+ *          can't be reached.
+ */
+export function weightedRectangleExpansionAStar(
+    source: Point2,
+    target: Point2,
+    map: WeightedREAStarMap,
+    maxcost: number
+): Deque<Point2> | undefined
+{
+    if (!WASM) throw "REA* is uninitialized";
+
+    const owned = map.costGrid?.();
+    const grid = owned ?? createCostGrid(map);
+
+    const size = WASM.weightedRectangleExpansionAStar(
+        source,
+        target,
+        grid,
+        Math.min(maxcost, 0x7fffffff)
+    );
+
+    if (!owned) grid.delete();
+
+    return readPath(size);
+}
+
+/**
+ * Applies REA* to find the shortest path from a point to the nearest of a set
+ * of targets on a map, with a single search.
+ * 
+ * The path ends on the closest target reached, and the search only stops
+ * once no other target could be closer. If none can be reached, the path
+ * leads as close as possible to one of them instead.
+ * 
+ * @param source - starting point.
+ * @param targets - goal points.
+ * @param map - colored map.
+ */
+export function rectangleExpansionAStarNearest(
+    source: Point2,
+    targets: Point2[],
+    map: REAStarMap,
+    maxlen: number
+): Deque<Point2> | undefined
+{
+    const buffer = new Int32Array(targets.length * 2);
+    targets.forEach((target, i) => buffer.set(target, i * 2));
+
+    return withGrid(map, grid => {
+        const size = WASM.rectangleExpansionAStarNearest(
+            source,
+            buffer,
+            grid,
+            Math.min(maxlen, 0x7fffffff)
+        );
+
+        return readPath(size);
+    });
+}
+
+/**
+ * Finds a path between two points on a map with a hierarchical search, for
+ * long paths on large maps.
+ * 
+ * The map is split into clusters, linked through the cells on their borders
+ * with REA* paths inside each cluster. The search runs on that small graph,
+ * and only the clusters on the path it picks are searched again to refine it.
+ * The abstraction is kept across calls, and only the clusters which changed
+ * are rebuilt, so the first search on a map is the slowest one.
+ * 
+ * Paths are not limited in length and might be slightly longer than the ones
+ * found by REA*. Sources and targets on blocked tiles, like those taken by
+ * characters, are left and entered through their free neighbors. Looping maps
+ * get no path, since clusters don't link across their edges.
+ * 
+ * @param source - starting point.
+ * @param target - goal point.
+ * @param map - colored map.
+ */
+export function hierarchicalAStar(
+    source: Point2,
+    target: Point2,
+    map: REAStarMap
+): Deque<Point2> | undefined
+{
+    return withGrid(map, grid => readPath(
+        WASM.hierarchicalAStar(source, target, grid)
+    ));
+}
+
+/**
+ * Applies JPS+ to find the shortest path between two points on a map.
+ * 
+ * Jump distances are kept for the last grid searched and updated where it
+ * changed, so searches are fastest when they keep using the persistent grid
+ * of the same map. Unlike REA*, paths follow the 8 directions exactly,
+ * without cutting corners. Looping maps get no path, since jumps stop at their
+ * edges.
+ * 
+ * @param source - starting point.
+ * @param target - goal point.
+ * @param map - colored map.
+ */
+export function jumpPointSearch(
+    source: Point2,
+    target: Point2,
+    map: REAStarMap,
+    maxlen: number
+): Deque<Point2> | undefined
+{
+    return withGrid(map, grid => {
+        const size = WASM.jumpPointSearch(
+            source,
+            target,
+            grid,
+            Math.min(maxlen, 0x7fffffff)
+        );
+
+        return readPath(size);
+    });
+}
+
+/**
+ * Applies plain A* to find the shortest 4-directional path between two points
+ * on a map.
+ * 
+ * Meant for short paths, where REA* and JPS+ gain nothing over it. If the
+ * target can't be reached, the path leads to the closest point found instead.
+ * 
+ * @param source - starting point.
+ * @param target - goal point.
+ * @param map - colored map.
+ */
+export function gridAStar(
+    source: Point2,
+    target: Point2,
+    map: REAStarMap,
+    maxlen: number
+): Deque<Point2> | undefined
+{
+    return withGrid(map, grid => {
+        const size = WASM.gridAStar(
+            source,
+            target,
+            grid,
+            Math.min(maxlen, 0x7fffffff)
+        );
+
+        return readPath(size);
+    });
+}
+
+/**
+ * Looks for a path between two points on the WASM path cache, which keeps the
+ * last complete paths found by REA*, JPS+ and the hierarchical search.
+ * 
+ * A cached path to the same target is reused if the source lies on any of its
+ * segments, so characters walking along a path or chasing the same target
+ * skip their searches. Paths are dropped when cells along them change, and
+ * the whole cache is emptied when the map's grid is replaced, so it only pays
+ * off on maps which own a persistent grid.
+ * 
+ * @param source - starting point.
+ * @param target - goal point.
+ * @param map - colored map.
+ * 
+ * @returns the rest of the cached path from the source, or undefined on a
+ *          miss.
+ */
+export function cachedPath(
+    source: Point2,
+    target: Point2,
+    map: REAStarMap,
     maxlen: number
 ): Deque<Point2> | undefined
+{
+    return withGrid(map, grid => {
+        const size = WASM.cachedPath(
+            source,
+            target,
+            grid,
+            Math.min(maxlen, 0x7fffffff)
+        );
+
+        return readPath(size);
+    });
+}
+
+/**
+ * @returns the counters for the last search made by `rectangleExpansionAStar`
+ *          or `rectangleExpansionAStarNearest`, or null if the WASM module
+ *          was built without them.
+ */
+export function getLastSearchStats(): SearchStats | null
 {
     if (!WASM) throw "REA* is uninitialized";
+    return WASM.getLastSearchStats();
+}
+
+/**
+ * Gets the distribution of the REA* searches made on the persistent grid of a
+ * map by `rectangleExpansionAStar` and `rectangleExpansionAStarNearest`.
+ * 
+ * The histogram is empty unless the WASM module was built with search
+ * counters.
+ * 
+ * @param map - colored map.
+ * @param reset - whether to start a new histogram afterwards.
+ * 
+ * @returns the histogram, or undefined if the map has no persistent grid.
+ */
+export function getSearchHistogram(
+    map: REAStarMap,
+    reset: boolean = false
+): SearchHistogram | undefined
+{
+    if (!WASM) throw "REA* is uninitialized";
+
+    const grid = map.booleanGrid?.();
+    if (!grid) return undefined;
+
+    const histogram = WASM.getSearchHistogram(grid);
+    if (reset) WASM.resetSearchHistogram(grid);
+
+    return histogram;
+}
+
+/**
+ * Corridor ratios of persistent grids, which are only measured once.
+ */
+const corridorRatios = new WeakMap<BooleanGrid, number>();
+
+/**
+ * Measures how much a map looks like a maze, as the fraction of its passable
+ * points with at most two passable neighbors.
+ * 
+ * REA* gains little on maps with a high ratio, since it can't expand large
+ * rectangles on them, while JPS+ is much faster there.
+ * 
+ * @param map - colored map.
+ */
+export function corridorRatio(map: REAStarMap): number
+{
+    return withGrid(map, grid => {
+        let ratio = corridorRatios.get(grid);
+        if (ratio === undefined)
+        {
+            ratio = WASM.corridorRatio(grid);
+            if (map.booleanGrid) corridorRatios.set(grid, ratio);
+        }
+
+        return ratio;
+    });
+}
+
+/**
+ * Applies REA* to a batch of queries on the same map with a single call into
+ * WASM.
+ * 
+ * @param queries - path queries.
+ * @param map - colored map.
+ * 
+ * @returns the path found for each query, in order.
+ */
+export function rectangleExpansionAStarBatch(
+    queries: PathQuery[],
+    map: REAStarMap
+): (Deque<Point2> | undefined)[]
+{
+    const buffer = queryBuffer(queries);
+
+    return withGrid(map, grid => readBatch(
+        WASM.rectangleExpansionAStarBatch(buffer, grid),
+        queries.length
+    ));
+}
+
+type PathRequest = PathQuery & { callback: (path?: Deque<Point2>) => void };
+
+/**
+ * Queued REA* searches, by map.
+ */
+const queue = new Map<REAStarMap, PathRequest[]>();
 
-    let grid = new WASM.BooleanGrid(map);
+/**
+ * Batch of REA* searches running on the WASM solver pool, along with the
+ * temporary grid created for it, if any.
+ */
+let running: {
+    requests: PathRequest[],
+    valid: PathRequest[],
+    temporary?: BooleanGrid
+} | undefined;
+
+/**
+ * Queues a REA* search, to be run along with every other queued search on the
+ * same map on the next call to `flushRectangleExpansionAStar`.
+ * 
+ * @param source - starting point.
+ * @param target - goal point.
+ * @param map - colored map.
+ * @param callback - function receiving the path found.
+ */
+export function queueRectangleExpansionAStar(
+    source: Point2,
+    target: Point2,
+    map: REAStarMap,
+    maxlen: number,
+    callback: (path?: Deque<Point2>) => void
+): void
+{
+    const requests = queue.get(map) ?? [];
+    requests.push({ source, target, maxlen, callback });
+    queue.set(map, requests);
+}
+
+/**
+ * Starts running all queued REA* searches on the WASM solver pool, one batch
+ * per map. Their callbacks are called once the batch is settled, which
+ * happens on the next flush at the latest.
+ * 
+ * On builds with worker threads, the searches run in the background while
+ * the game goes on. Otherwise, they run right away.
+ * 
+ * Searches with points no longer inside their maps (e.g. after a transfer)
+ * are dropped and receive no path.
+ * 
+ * @see settleRectangleExpansionAStar
+ */
+export function flushRectangleExpansionAStar(): void
+{
+    const batches = [...queue];
+    queue.clear();
+
+    for (const [map, requests] of batches)
+    {
+        settleRectangleExpansionAStar();
+
+        const valid = requests.filter(({ source, target }) =>
+            map.contains(source) && map.contains(target));
+
+        const owned = map.booleanGrid?.();
+        const grid = owned ?? createBooleanGrid(map);
+
+        WASM.rectangleExpansionAStarSubmit(queryBuffer(valid), grid);
+        running = { requests, valid, temporary: owned ? undefined : grid };
+    }
+}
+
+/**
+ * Waits for the searches running on the WASM solver pool, if any, and calls
+ * their callbacks.
+ * 
+ * Grids used by the searches must not be modified until they are settled.
+ */
+export function settleRectangleExpansionAStar(): void
+{
+    if (!running) return;
+
+    const { requests, valid, temporary } = running;
+    running = undefined;
+
+    const paths = readBatch(
+        WASM.rectangleExpansionAStarCollect(),
+        valid.length
+    );
+
+    temporary?.delete();
+
+    const found = new Map(valid.map((request, i) => [request, paths[i]]));
+    requests.forEach(request => request.callback(found.get(request)));
+}
+
+/**
+ * @returns whether the searches running on the WASM solver pool, if any, have
+ *          finished, so that settling them would not block.
+ */
+export function isRectangleExpansionAStarReady(): boolean
+{
+    return !running || WASM.rectangleExpansionAStarReady();
+}
 
-    const path = WASM.rectangleExpansionAStar(source, target, grid, maxlen);
-    if (!path) return undefined;
+/**
+ * Packs path queries into the flat buffer taken by the WASM module.
+ */
+function queryBuffer(queries: PathQuery[]): Int32Array
+{
+    const buffer = new Int32Array(queries.length * 5);
+    queries.forEach(({ source: [sx, sy], target: [tx, ty], maxlen }, i) => {
+        buffer.set([sx, sy, tx, ty, Math.min(maxlen, 0x7fffffff)], i * 5);
+    });
+
+    return buffer;
+}
+
+/**
+ * Reads the paths for a batch of queries from the WASM batch buffers.
+ * 
+ * @param batch - views over the batch buffers.
+ * @param count - number of queries on the batch.
+ */
+function readBatch(
+    { points, offsets }: { points: Int32Array, offsets: Int32Array },
+    count: number
+): (Deque<Point2> | undefined)[]
+{
+    const paths: (Deque<Point2> | undefined)[] = [];
+    for (let i = 0; i < count; i++)
+    {
+        const start = offsets[i];
+        const end = offsets[i + 1];
+        if (start === end)
+        {
+            paths.push(undefined);
+            continue;
+        }
+
+        const path = new Deque<Point2>();
+        for (let j = start; j < end; j++)
+        {
+            path.push([points[2 * j], points[2 * j + 1]]);
+        }
+
+        paths.push(path);
+    }
+
+    return paths;
+}
+
+/**
+ * Incremental REA* search, which can be spread across several frames by
+ * expanding only a few nodes at a time.
+ * 
+ * The search keeps using the grid of the map it was started on. If the map
+ * drops that grid (e.g. after a transfer), the search fails.
+ * 
+ * Instances hold memory on the WASM heap and must be released with `delete()`
+ * once no longer needed.
+ */
+export class RectangleExpansionAStarSearch
+{
+    private readonly _search: REAStarWASM.REAStarSearch;
+
+    private _map?: REAStarMap;
+    private _grid?: BooleanGrid;
+    private _temporary: boolean = false;
+    private _status: SearchStatus = 'failed';
+
+    constructor()
+    {
+        if (!WASM) throw "REA* is uninitialized";
+        this._search = new WASM.REAStarSearch();
+    }
+
+    /**
+     * Starts searching for a path between two points on a map, dropping the
+     * current search.
+     * 
+     * @param source - starting point.
+     * @param target - goal point.
+     * @param map - colored map.
+     */
+    begin(source: Point2, target: Point2, map: REAStarMap, maxlen: number): void
+    {
+        settleRectangleExpansionAStar();
+        this.release();
+
+        const owned = map.booleanGrid?.();
+
+        this._map = map;
+        this._grid = owned ?? createBooleanGrid(map);
+        this._temporary = !owned;
+
+        this._search.begin(
+            source,
+            target,
+            this._grid,
+            Math.min(maxlen, 0x7fffffff)
+        );
+
+        this._status = SEARCH_STATUSES[this._search.status()];
+    }
+
+    /**
+     * Continues the search.
+     * 
+     * @param maxExpansions - maximum number of nodes to expand.
+     * 
+     * @returns the state of the search.
+     */
+    step(maxExpansions: number): SearchStatus
+    {
+        if (this.isValid())
+        {
+            this._status = SEARCH_STATUSES[this._search.step(maxExpansions)];
+        }
+
+        return this._status;
+    }
+
+    /**
+     * Continues the search for a given time, expanding at least one node.
+     * 
+     * @param microseconds - time budget.
+     * 
+     * @returns the state of the search.
+     */
+    stepFor(microseconds: number): SearchStatus
+    {
+        if (this.isValid())
+        {
+            this._status = SEARCH_STATUSES[this._search.stepFor(microseconds)];
+        }
+
+        return this._status;
+    }
+
+    /**
+     * @returns the state of the search.
+     */
+    status(): SearchStatus
+    {
+        return this._status;
+    }
+
+    /**
+     * @param from - point from which to start the path, if it is on it.
+     * 
+     * @returns the path found by the search, or the path to the closest point
+     *          found so far if it has not reached the target.
+     */
+    path(from?: Point2): Deque<Point2> | undefined
+    {
+        if (!this._grid) return undefined;
+
+        return readPath(this._search.path(), from);
+    }
+
+    /**
+     * Releases the search from the WASM heap.
+     */
+    delete(): void
+    {
+        this.release();
+        this._search.delete();
+    }
+
+    /**
+     * Checks whether the grid for the search is still alive, failing the
+     * search otherwise.
+     */
+    private isValid(): boolean
+    {
+        if (!this._grid || this._status !== 'in-progress') return false;
+
+        settleRectangleExpansionAStar();
+
+        if (!this._temporary && this._map!.booleanGrid?.() !== this._grid)
+        {
+            this._grid = undefined;
+            this._status = 'failed';
+            return false;
+        }
+
+        return true;
+    }
+
+    private release(): void
+    {
+        if (this._temporary) this._grid?.delete();
+
+        this._map = undefined;
+        this._grid = undefined;
+        this._temporary = false;
+        this._status = 'failed';
+    }
+}
+
+/**
+ * Distance field rooted at a target, shared by searches from many sources to
+ * that target.
+ * 
+ * The field is built on the WASM module up to a given distance from the
+ * target, and rebuilt only when the target, the radius or the grid of the map
+ * change. Each search then just walks the field. It only pays off on maps
+ * which own a persistent grid.
+ * 
+ * Instances hold memory on the WASM heap and must be released with `delete()`
+ * once no longer needed.
+ */
+export class DistanceField
+{
+    private readonly _field: REAStarWASM.DistanceField;
+
+    constructor()
+    {
+        if (!WASM) throw "REA* is uninitialized";
+        this._field = new WASM.DistanceField();
+    }
+
+    /**
+     * Finds the shortest path between two points on a map through the field,
+     * rebuilding it first if needed.
+     * 
+     * @param source - starting point.
+     * @param target - goal point.
+     * @param map - colored map.
+     * @param radius - maximum distance from the target covered by the field.
+     * 
+     * @returns the path, or undefined if the source is not covered by the
+     *          field or the map loops. Sources on blocked tiles, like the
+     *          tile taken by the character searching, are covered through
+     *          their neighbors.
+     */
+    path(
+        source: Point2,
+        target: Point2,
+        map: REAStarMap,
+        radius: number
+    ): Deque<Point2> | undefined
+    {
+        return withGrid(map, grid => readPath(
+            this._field.path(source, target, grid, radius)
+        ));
+    }
+
+    /**
+     * Releases the field from the WASM heap.
+     */
+    delete(): void
+    {
+        this._field.delete();
+    }
+}
+
+/**
+ * Reads the path found by the last single search from the WASM path buffer.
+ * 
+ * @param size - number of points on the path.
+ * @param from - point from which to start the path, if it is on it.
+ */
+function readPath(size: number, from?: Point2): Deque<Point2> | undefined
+{
+    if (size === 0) return undefined;
+
+    const points = WASM.pathBuffer();
+
+    let start = 0;
+    if (from)
+    {
+        const [x, y] = from;
+        for (let i = 0; i < size; i++)
+        {
+            if (points[2 * i] === x && points[2 * i + 1] === y)
+            {
+                start = i;
+                break;
+            }
+        }
+    }
 
-    const size = path.size();
     const result = new Deque<Point2>();
-    for (let i = 0; i < size; i++) result.push(path.get(i));
+    for (let i = start; i < size; i++)
+    {
+        result.push([points[2 * i], points[2 * i + 1]]);
+    }
+
+    return result;
+}
+
+/**
+ * Calls a function with the grid for a map, creating a temporary one if the
+ * map doesn't own one.
+ */
+function withGrid<T>(map: REAStarMap, f: (grid: BooleanGrid) => T): T
+{
+    if (!WASM) throw "REA* is uninitialized";
+
+    settleRectangleExpansionAStar();
+
+    const owned = map.booleanGrid?.();
+    const grid = owned ?? createBooleanGrid(map);
 
-    grid.delete();
-    path.delete();
+    const result = f(grid);
+    if (!owned) grid.delete();
 
     return result;
 }
+
+/**
+ * Computes the passability buffer for a map, using its own implementation if
+ * it is rasterizable.
+ * 
+ * @param map - colored map.
+ * 
+ * @returns a row-major buffer with one byte per point, with its lowest bit set
+ *          for passable points.
+ */
+function passability(
+    map: SquareGridMap & Colored<Point2, boolean> & Partial<Rasterizable>
+): Uint8Array
+{
+    if (map.passability) return map.passability();
+
+    const { width, height } = map;
+    const buffer = new Uint8Array(width * height);
+    for (let y = 0; y < height; y++)
+    {
+        for (let x = 0; x < width; x++)
+        {
+            buffer[x + y * width] = +!!map.color([x, y]);
+        }
+    }
+
+    return buffer;
+}
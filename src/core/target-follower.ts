@@ -22,6 +22,12 @@ export interface TargetFollowingStrategy<U, G extends Graph<U>>
      */
     path(): Deque<U> | undefined;
 
+    /**
+     * @returns whether a path is still being calculated, in which case the
+     *          follower should wait for it instead of using `path()`.
+     */
+    pending?(): boolean;
+
     /**
      * Updates path calculation.
      * 
@@ -46,6 +52,11 @@ export interface TargetFollowingStrategy<U, G extends Graph<U>>
      * @param v - the actual vertex where the follower stopped.
      */
     onFinish(map: G, v: U): boolean;
+
+    /**
+     * Releases any resources held by the strategy once it is no longer used.
+     */
+    dispose?(): void;
 }
 
 /**
@@ -8,14 +8,28 @@
  * Definitions for the graph representing the game map.
  */
 
-import { Point2, SquareGridMap } from '../data/square-grid';
+import {
+    Looping,
+    Point2,
+    Rasterizable,
+    SquareGridMap,
+    Walled
+} from '../data/square-grid';
 import { Colored, Weighted } from './graph';
 
+import type { BooleanGrid, BooleanGridOwner } from '../algorithm/rea-star';
+
 declare class Game_Vehicle {
+    get x(): number;
+    get y(): number;
+    isThrough(): boolean;
     posNt(x: number, y: number): boolean;
 }
 
 declare class Game_Event {
+    get x(): number;
+    get y(): number;
+    isThrough(): boolean;
     isNormalPriority(): boolean;
 }
 
@@ -24,13 +38,17 @@ declare const $gameMap: {
     height(): number;
     roundXWithDirection(x: number, d: number): number;
     roundYWithDirection(y: number, d: number): number;
+    isLoopHorizontal(): boolean;
+    isLoopVertical(): boolean;
     checkPassage(x: number, y: number, flag: number): boolean;
     isValid(x: number, y: number): boolean;
     isPassable(x: number, y: number, d: number): boolean;
     boat(): Game_Vehicle;
     ship(): Game_Vehicle;
+    events(): Game_Event[];
     eventsXyNt(x: number, y: number): Game_Event[];
     tilesetFlags(): number[];
+    pathfindingGrid(): BooleanGrid;
 };
 
 declare const $dataMap: {
@@ -40,12 +58,20 @@ declare const $dataMap: {
 /**
  * Game map graph implementation.
  * 
- * The colors on the graph represent the adirectional passability on the map
- * (tiles not passable by either direction will be considered unpassable), and
- * weights are calculated using Manhattan distance (tiled walk distance). 
+ * The colors on the graph represent whether tiles can be stood on (tiles
+ * blocked in every direction or taken by an event, the boat or the ship will
+ * be considered unpassable), with the directions blocked on the rest given by
+ * their walls, and weights are calculated using Manhattan distance (tiled
+ * walk distance). 
  */
 export class GameMapGraph extends SquareGridMap
-    implements Colored<Point2, boolean>, Weighted<Point2>
+    implements
+        Colored<Point2, boolean>,
+        Weighted<Point2>,
+        Rasterizable,
+        Walled,
+        Looping,
+        BooleanGridOwner
 {
     get width(): number
     {
@@ -57,6 +83,16 @@ export class GameMapGraph extends SquareGridMap
         return $gameMap.height();
     }
 
+    get loopsHorizontally(): boolean
+    {
+        return $gameMap.isLoopHorizontal();
+    }
+
+    get loopsVertically(): boolean
+    {
+        return $gameMap.isLoopVertical();
+    }
+
     from([x, y]: Point2): Point2[]
     {
         const neighbors: Point2[] = [];
@@ -73,20 +109,58 @@ export class GameMapGraph extends SquareGridMap
     color([x, y]: Point2): boolean
     {
         if (this.collidesWithEvents(x, y)) return false;
+        if (this.collidesWithVehicles(x, y)) return false;
+        return this.tileWalls(x, y, $gameMap.tilesetFlags()) !== 0xf;
+    }
+
+    walls([x, y]: Point2): number
+    {
+        return this.tileWalls(x, y, $gameMap.tilesetFlags());
+    }
 
+    /**
+     * Computes the color of every vertex on the graph in a single pass.
+     */
+    passability(): Uint8Array
+    {
         const width = this.width;
         const height = this.height;
         const flags = $gameMap.tilesetFlags();
-        for (let z = 3; z >= 0; z--)
+
+        const buffer = new Uint8Array(width * height);
+        for (let y = 0; y < height; y++)
         {
-            const tile = $dataMap.data[(z * height + y) * width + x] || 0;
-            const flag = flags[tile];
+            for (let x = 0; x < width; x++)
+            {
+                const walls = this.tileWalls(x, y, flags);
+                buffer[x + y * width] = walls === 0xf ? 0 : 1 | walls << 1;
+            }
+        }
 
-            if ((flag & 0x10) !== 0) continue;
-            return (flag & 0xf) === 0;
+        // Tiles taken by events and vehicles keep their walls, so that they
+        // are still there once the tile is freed.
+        for (const event of $gameMap.events())
+        {
+            if (event.isThrough() || !event.isNormalPriority()) continue;
+
+            const { x, y } = event;
+            if (this.contains([x, y])) buffer[x + y * width] &= ~1;
+        }
+
+        for (const vehicle of [$gameMap.boat(), $gameMap.ship()])
+        {
+            if (vehicle.isThrough()) continue;
+
+            const { x, y } = vehicle;
+            if (this.contains([x, y])) buffer[x + y * width] &= ~1;
         }
 
-        return true;
+        return buffer;
+    }
+
+    booleanGrid(): BooleanGrid
+    {
+        return $gameMap.pathfindingGrid();
     }
 
     weight(source: Point2, target: Point2): number {
@@ -103,12 +177,29 @@ export class GameMapGraph extends SquareGridMap
             return false;
         }
 
-        if ($gameMap.boat().posNt(x, y) || $gameMap.ship().posNt(x, y))
+        if (this.collidesWithVehicles(x, y)) return false;
+
+        return !this.collidesWithEvents(x, y);
+    }
+
+    /**
+     * @returns the directional passage flags of the topmost tile that isn't
+     *          a star tile, as on `Game_Map.checkPassage`.
+     */
+    private tileWalls(x: number, y: number, flags: number[]): number
+    {
+        const width = this.width;
+        const height = this.height;
+        for (let z = 3; z >= 0; z--)
         {
-            return false;
+            const tile = $dataMap.data[(z * height + y) * width + x] || 0;
+            const flag = flags[tile];
+
+            if ((flag & 0x10) !== 0) continue;
+            return flag & 0xf;
         }
 
-        return !this.collidesWithEvents(x, y);
+        return 0;
     }
 
     private collidesWithEvents(x: number, y: number): boolean
@@ -116,4 +207,9 @@ export class GameMapGraph extends SquareGridMap
         const events = $gameMap.eventsXyNt(x, y);
         return events.some(e => e.isNormalPriority());
     }
+
+    private collidesWithVehicles(x: number, y: number): boolean
+    {
+        return $gameMap.boat().posNt(x, y) || $gameMap.ship().posNt(x, y);
+    }
 }
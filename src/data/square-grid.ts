@@ -12,6 +12,67 @@ import { Graph } from "../data/graph";
 
 export type Point2 = [number, number];
 
+/**
+ * Interface for a square grid map with boolean colors that can be computed
+ * all at once.
+ */
+export interface Rasterizable
+{
+    /**
+     * @returns a row-major buffer with one byte per vertex, with its lowest
+     *          bit set for vertices colored `true`. Walled maps may also hold
+     *          the walls of each vertex on bits 1 to 4, even on vertices
+     *          colored `false`, which keep them once they are freed.
+     */
+    passability(): Uint8Array;
+}
+
+/**
+ * Interface for a square grid map where vertices can block movement through
+ * some of their sides, like RPG Maker's directional passage flags.
+ */
+export interface Walled
+{
+    /**
+     * @param p - vertex.
+     * 
+     * @returns a mask of the directions the vertex can't be left or entered
+     *          through: 0x1 for down, 0x2 for left, 0x4 for right and 0x8 for
+     *          up.
+     */
+    walls(p: Point2): number;
+}
+
+/**
+ * Interface for a square grid map which may wrap around at its edges, like
+ * RPG Maker's looping maps.
+ */
+export interface Looping
+{
+    /**
+     * Whether the leftmost and rightmost columns are next to each other.
+     */
+    readonly loopsHorizontally: boolean;
+
+    /**
+     * Whether the topmost and bottommost rows are next to each other.
+     */
+    readonly loopsVertically: boolean;
+}
+
+/**
+ * Interface for a square grid map where moving into each vertex has a cost.
+ */
+export interface Costed
+{
+    /**
+     * @returns a row-major buffer with one byte per vertex, holding the cost
+     *          of moving into it (from 1 to 255), or zero if it can't be
+     *          entered.
+     */
+    costs(): Uint8Array;
+}
+
 /**
  * Square grid map graph interface.
  */
@@ -9,6 +9,7 @@ import "./patch/game-character";
 import "./patch/game-player";
 import "./patch/game-map";
 import "./patch/game-system";
+import "./patch/scene-map";
 
 import "./plugin";
 
@@ -65,6 +65,8 @@ Game_Character.prototype.updateStop = function() {
 
     if (this._pathFollowingStrategy) {
         this._pathFollowingStrategy.update($gameMap.graph());
+        if (this._pathFollowingStrategy.pending?.()) return;
+
         this._assignedPath = this._pathFollowingStrategy.path();
     }
 
@@ -77,12 +79,14 @@ Game_Character.prototype.follow = function<T  extends Game_Character | Point2>(
 ): void
 {
     Game_Character.followingPath++;
+    this._pathFollowingStrategy?.dispose?.();
     this._pathFollowingStrategy = new strategy(this, target);
 }
 
 Game_Character.prototype.clearPathFollowingStrategy = function(): void
 {
     Game_Character.followingPath--;
+    this._pathFollowingStrategy?.dispose?.();
     this._pathFollowingStrategy = undefined;
 }
 
@@ -130,6 +134,7 @@ Game_Character.prototype.onFinishFollowingPath = function(): void
         );
 
         if (!finished) {
+            if (this._pathFollowingStrategy.pending?.()) return;
             this.assignPath(this._pathFollowingStrategy.path());
             return;
         }
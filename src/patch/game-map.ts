@@ -1,10 +1,68 @@
 import { GameMapGraph } from "../data/game-map-graph";
+import { Point2 } from "../data/square-grid";
+import {
+    BooleanGrid,
+    createBooleanGrid,
+    settleRectangleExpansionAStar
+} from "../algorithm/rea-star";
+import { clearSharedFields } from "../strategy/standard";
+
+declare class Game_Vehicle {
+    get x(): number;
+    get y(): number;
+    isThrough(): boolean;
+}
+
+declare class Game_Event {
+    get x(): number;
+    get y(): number;
+    eventId(): number;
+    isThrough(): boolean;
+    isNormalPriority(): boolean;
+}
 
 export declare class Game_Map {
     initialize(): void;
+    setup(mapId: number): void;
+    update(sceneActive: boolean): void;
+    width(): number;
+    isValid(x: number, y: number): boolean;
+    events(): Game_Event[];
+    boat(): Game_Vehicle;
+    ship(): Game_Vehicle;
+
     graph(): GameMapGraph;
+
+    pathfindingGrid(): BooleanGrid;
+    invalidatePathfindingGrid(
+        x: number,
+        y: number,
+        width: number,
+        height: number
+    ): void;
+    updatePathfindingGrid(): void;
+    clearPathfindingGrid(): void;
+
+    private _graph: GameMapGraph;
 }
 
+/**
+ * Persistent pathfinding grid for a map, along with the cells blocked by each
+ * event and by the boat and ship when it was last updated.
+ * 
+ * This is kept out of the map object itself so that it is not saved. Only one
+ * map can own a grid at a time, so that grids from discarded maps (e.g. after
+ * loading a save) are released.
+ */
+type GridState = {
+    map: Game_Map,
+    grid: BooleanGrid,
+    blocked: number[],
+    vehicles: number[]
+};
+
+let gridState: GridState | undefined;
+
 const initialize = Game_Map.prototype.initialize;
 Game_Map.prototype.initialize = function(): void
 {
@@ -12,7 +70,130 @@ Game_Map.prototype.initialize = function(): void
     this._graph = new GameMapGraph();
 }
 
+const setup = Game_Map.prototype.setup;
+Game_Map.prototype.setup = function(mapId: number): void
+{
+    setup.call(this, mapId);
+    this.clearPathfindingGrid();
+
+    // Events from the previous map are dropped along with their strategies,
+    // which never get to leave their shared fields.
+    clearSharedFields();
+}
+
+const update = Game_Map.prototype.update;
+Game_Map.prototype.update = function(sceneActive: boolean): void
+{
+    settleRectangleExpansionAStar();
+    update.call(this, sceneActive);
+    this.updatePathfindingGrid();
+}
+
 Game_Map.prototype.graph = function(): GameMapGraph
 {
     return this._graph;
 }
+
+/**
+ * @returns the persistent grid used for REA* on this map, built on the first
+ *          call after the map is loaded. Since it is reused by every search on
+ *          the map, it also keeps a clearance index to speed up expansions.
+ */
+Game_Map.prototype.pathfindingGrid = function(): BooleanGrid
+{
+    if (gridState?.map !== this)
+    {
+        gridState?.map.clearPathfindingGrid();
+        gridState = {
+            map: this,
+            grid: createBooleanGrid(this.graph()),
+            blocked: [],
+            vehicles: []
+        };
+
+        gridState.grid.buildClearance();
+        this.updatePathfindingGrid();
+    }
+
+    return gridState.grid;
+}
+
+/**
+ * Marks a region of the pathfinding grid to be recalculated, e.g. after tiles
+ * on it have changed.
+ */
+Game_Map.prototype.invalidatePathfindingGrid = function(
+    x: number,
+    y: number,
+    width: number,
+    height: number
+): void
+{
+    if (gridState?.map !== this) return;
+
+    settleRectangleExpansionAStar();
+    gridState.grid.invalidate(x, y, x + width - 1, y + height - 1);
+}
+
+/**
+ * Updates the cells on the pathfinding grid which had events, the boat or the
+ * ship moving into or out of them since the last update.
+ */
+Game_Map.prototype.updatePathfindingGrid = function(): void
+{
+    if (gridState?.map !== this) return;
+
+    settleRectangleExpansionAStar();
+
+    const { grid, blocked, vehicles } = gridState;
+    const graph = this.graph();
+    const width = this.width();
+
+    const refresh = (i: number) => {
+        const p: Point2 = [i % width, Math.floor(i / width)];
+        grid.set(p, graph.color(p));
+    };
+
+    const move = (cells: number[], id: number, current: number) => {
+        const previous = cells[id] ?? -1;
+        if (previous === current) return;
+
+        cells[id] = current;
+        if (previous >= 0) refresh(previous);
+        if (current >= 0) refresh(current);
+    };
+
+    for (const event of this.events())
+    {
+        move(
+            blocked,
+            event.eventId(),
+            event.isThrough() || !event.isNormalPriority()
+                ? -1
+                : event.x + event.y * width
+        );
+    }
+
+    // Vehicles parked on other maps keep their coordinates there, which may
+    // lie outside of this one.
+    [this.boat(), this.ship()].forEach((vehicle, id) => move(
+        vehicles,
+        id,
+        vehicle.isThrough() || !this.isValid(vehicle.x, vehicle.y)
+            ? -1
+            : vehicle.x + vehicle.y * width
+    ));
+}
+
+/**
+ * Releases the pathfinding grid, if any.
+ */
+Game_Map.prototype.clearPathfindingGrid = function(): void
+{
+    if (gridState?.map !== this) return;
+
+    settleRectangleExpansionAStar();
+
+    gridState.grid.delete();
+    gridState = undefined;
+}
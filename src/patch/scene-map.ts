@@ -0,0 +1,13 @@
+import { flushRectangleExpansionAStar } from "../algorithm/rea-star";
+
+declare class Scene_Map
+{
+    updateMain(): void;
+}
+
+const updateMain = Scene_Map.prototype.updateMain;
+Scene_Map.prototype.updateMain = function(): void
+{
+    updateMain.call(this);
+    flushRectangleExpansionAStar();
+}
@@ -53,6 +53,10 @@ export class LoopingStrategy<
         return this._wrapped.path();
     }
 
+    pending(): boolean {
+        return this._wrapped.pending?.() ?? false;
+    }
+
     update(map: U): void {
         this._wrapped.update(map);
     }
@@ -61,6 +65,10 @@ export class LoopingStrategy<
         this._wrapped.onFail(map);
     }
 
+    dispose(): void {
+        this._wrapped.dispose?.();
+    }
+
     onFinish(map: U, v: T): boolean {
         this._wrapped.onFinish(map, v);
         return false;
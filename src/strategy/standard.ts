@@ -9,12 +9,21 @@
  */
 
 import { TargetFollowingStrategy } from '../core/target-follower';
-import { Point2, SquareGridMap } from '../data/square-grid';
+import { Looping, Point2, SquareGridMap } from '../data/square-grid';
 import { Deque } from '../util/deque';
 
-import { rectangleExpansionAStar } from '../algorithm/rea-star';
+import {
+    cachedPath,
+    corridorRatio,
+    DistanceField,
+    gridAStar,
+    hierarchicalAStar,
+    jumpPointSearch,
+    rectangleExpansionAStar,
+    queueRectangleExpansionAStar,
+    RectangleExpansionAStarSearch
+} from '../algorithm/rea-star';
 import { Colored, Weighted } from '../data/graph';
-import { aStar } from '../algorithm/a-star';
 
 /**
  * Game character class declaration.
@@ -35,6 +44,49 @@ declare class Game_Character
 export type StandardMap =
     SquareGridMap & Colored<Point2, boolean> & Weighted<Point2>;
 
+/**
+ * Search engines available to the standard strategy for long paths.
+ */
+export type PathEngine = 'rea-star' | 'jump-point';
+
+/**
+ * Distance field shared by the strategies following the same target.
+ */
+type SharedField = { users: number, field?: DistanceField };
+
+/**
+ * Shared distance fields, by target character or by the coordinates of a
+ * target point.
+ */
+const sharedFields = new Map<object | string, SharedField>();
+
+/**
+ * Number of times the shared fields were cleared. Strategies joined to a field
+ * before the last clear join it again on their next search.
+ */
+let sharedFieldsGeneration = 0;
+
+/**
+ * Releases every shared distance field, e.g. when a new map is set up and the
+ * strategies on the previous one are discarded without being disposed.
+ */
+export function clearSharedFields(): void
+{
+    for (const shared of sharedFields.values()) shared.field?.delete();
+
+    sharedFields.clear();
+    sharedFieldsGeneration++;
+}
+
+/**
+ * @returns whether a map wraps around along any axis.
+ */
+function loops(map: StandardMap): boolean
+{
+    const looping = map as Partial<Looping>;
+    return !!(looping.loopsHorizontally || looping.loopsVertically);
+}
+
 /**
  * Standard path following strategy.
  * 
@@ -45,6 +97,11 @@ export type StandardMap =
  * fallback to simple A* when it fails to derive a full path from that
  * approach.
  * 
+ * Plain A* runs on the same grid as REA*, so the fallback can't find routes
+ * REA* missed. It only helps when the last path was cut short by the step
+ * limit or the grid changed since it was found, as when an event or vehicle
+ * moved out of the way.
+ * 
  * This strategy completes once the source character reaches the desired target
  * **EXACTLY**. Touching an event does not count as completing the full path.
  * It will keep looking for paths until it is completed.
@@ -54,6 +111,30 @@ export type StandardMap =
  * or the target's position changes (so be cautious when using it on moving
  * events).
  * 
+ * REA* searches are queued and run in a single batch with every other search
+ * made in the same frame, in the background on builds with worker threads.
+ * Their paths are only available on the next frame. Override `batched` to run
+ * them immediately instead.
+ * 
+ * Long REA* searches are instead spread across several updates, expanding a
+ * limited number of nodes on each. Meanwhile, the path to the closest point
+ * found so far is followed.
+ * 
+ * Very long paths are found with a hierarchical search over the whole map
+ * instead, which has no step limit. If it fails, the incremental REA* search
+ * is used.
+ * 
+ * Strategies following the same character or point share a distance field
+ * rooted at it once there are enough of them, and walk it instead of
+ * searching. Fields are released whenever a new map is set up, and the
+ * strategies still around join them again on their next search.
+ * 
+ * On maze-like maps, JPS+ runs immediately instead of REA*. Override `engine`
+ * to choose the engine for each search.
+ * 
+ * On looping maps, only REA* and plain A* are used, since the other searches
+ * don't cross the edges of the map.
+ * 
  * Paths are limited to 128 steps for REA* and 32 for plain A* to avoid
  * lagging. Some optimizations are applied to avoid running to far when the
  * target is close to the source.
@@ -73,6 +154,15 @@ export class StandardStrategy
     private _targetY: number;
 
     private _cached?: Deque<Point2>;
+    private _pending: boolean = false;
+    private _requests: number = 0;
+
+    private _search?: RectangleExpansionAStarSearch;
+    private _searching: boolean = false;
+
+    private readonly _sharedKey: object | string;
+    private _shared?: SharedField;
+    private _sharedGeneration: number = -1;
 
     /**
      * @param source - Source character. 
@@ -83,9 +173,17 @@ export class StandardStrategy
         this._source = source;
 
         if (target instanceof Array)
+        {
             this._target = { x: target[0], y: target[1] };
+            this._sharedKey = `${target[0]},${target[1]}`;
+        }
         else
+        {
             this._target = target;
+            this._sharedKey = target;
+        }
+
+        this.joinSharedField();
     }
 
     path(): Deque<Point2> | undefined
@@ -93,9 +191,34 @@ export class StandardStrategy
         return this._cached;
     }
 
+    pending(): boolean
+    {
+        return this._pending;
+    }
+
     update(map: StandardMap): void
     {
         if (this.shouldRefresh()) this.refresh(map);
+        else if (this._searching) this.stepSearch();
+    }
+
+    dispose(): void
+    {
+        this._search?.delete();
+        this._search = undefined;
+        this._searching = false;
+
+        if (
+            this._shared
+            && this._sharedGeneration === sharedFieldsGeneration
+            && --this._shared.users === 0
+        )
+        {
+            this._shared.field?.delete();
+            sharedFields.delete(this._sharedKey);
+        }
+
+        this._shared = undefined;
     }
 
     onFail(map: StandardMap): void {
@@ -126,7 +249,8 @@ export class StandardStrategy
      * Recalculates the path to the target.
      * 
      * @param map - Graph on which to calculate the path.
-     * @param fallback - Whether to apply fallback behavior (i.e. plain A*).
+     * @param fallback - Whether to apply fallback behavior (i.e. plain A* on
+     *                   the same grid, from wherever the source stopped).
      */
     refresh(map: StandardMap, fallback: boolean = false): void
     {
@@ -139,16 +263,94 @@ export class StandardStrategy
         const target: Point2 = [this._targetX, this._targetY];
         
         const h = SquareGridMap.d1(source, target);
+        const looping = loops(map);
+
+        const request = ++this._requests;
+        this._pending = false;
+        this._searching = false;
 
         let path: Deque<Point2> | undefined;
         if (fallback || h < this.reaStarThreshold()) {
-            path = aStar(
+            path = gridAStar(
                 source,
                 target,
                 map,
-                SquareGridMap.d1,
                 this.aStarSearchLimit(source, target)
             );
+        } else if (
+            this.pathCaching()
+            && (path = cachedPath(
+                source,
+                target,
+                map,
+                this.reaStarSearchLimit(source, target)
+            ))
+        ) {
+            // Reuses the rest of a path found by an earlier search.
+        } else if (
+            !looping
+            && (path = this.sharedField()?.path(
+                source,
+                target,
+                map,
+                this.sharedFieldRadius()
+            ))
+        ) {
+            // Follows the field shared by every strategy on the same target.
+        } else if (
+            !looping
+            && h >= this.hierarchicalThreshold()
+            && (path = hierarchicalAStar(source, target, map))
+        ) {
+            path.shift();
+
+            this._cached = path;
+            return;
+        } else if (
+            !looping
+            && this.engine(source, target, map) === 'jump-point'
+        ) {
+            path = jumpPointSearch(
+                source,
+                target,
+                map,
+                this.reaStarSearchLimit(source, target)
+            );
+        } else if (h >= this.slicedThreshold()) {
+            if (!this._search)
+                this._search = new RectangleExpansionAStarSearch();
+
+            this._search.begin(
+                source,
+                target,
+                map,
+                this.reaStarSearchLimit(source, target)
+            );
+
+            this._searching = true;
+            this._pending = true;
+            this.stepSearch();
+
+            return;
+        } else if (this.batched()) {
+            this._pending = true;
+
+            queueRectangleExpansionAStar(
+                source,
+                target,
+                map,
+                this.reaStarSearchLimit(source, target),
+                path => {
+                    if (request !== this._requests) return;
+
+                    path?.shift();
+
+                    this._pending = false;
+                    this._cached = path;
+                }
+            );
+
+            return;
         } else {
             path = rectangleExpansionAStar(
                 source,
@@ -163,6 +365,149 @@ export class StandardStrategy
         this._cached = path;
     }
 
+    /**
+     * Runs a slice of the current incremental search. Its partial path is
+     * used until there is a complete one, as long as it leads anywhere.
+     */
+    private stepSearch(): void
+    {
+        const search = this._search!;
+        const status = search.step(this.sliceBudget());
+
+        if (status === 'in-progress')
+        {
+            if (!this._cached)
+            {
+                const partial = search.path();
+                if (partial && partial.length > 1)
+                {
+                    partial.shift();
+
+                    this._pending = false;
+                    this._cached = partial;
+                }
+            }
+
+            return;
+        }
+
+        const path = search.path([this._source.x, this._source.y]);
+        path?.shift();
+
+        this._searching = false;
+        this._pending = false;
+        this._cached = path;
+    }
+
+    /**
+     * Minimum distance between points such that REA* searches should be
+     * spread across several updates.
+     */
+    slicedThreshold(): number
+    {
+        return 32;
+    }
+
+    /**
+     * Chooses the engine for a search which is not short enough for plain A*
+     * nor long enough for the hierarchical search.
+     * 
+     * By default, JPS+ is used on maps where at least half of the passable
+     * points are on corridors, and REA* everywhere else.
+     */
+    engine(source: Point2, target: Point2, map: StandardMap): PathEngine
+    {
+        return corridorRatio(map) >= 0.5 ? 'jump-point' : 'rea-star';
+    }
+
+    /**
+     * Minimum distance between points such that the hierarchical search
+     * should be applied.
+     */
+    hierarchicalThreshold(): number
+    {
+        return 64;
+    }
+
+    /**
+     * Maximum number of nodes expanded on each update of a long REA*
+     * search.
+     */
+    sliceBudget(): number
+    {
+        return 128;
+    }
+
+    /**
+     * @returns the distance field shared with the other strategies following
+     *          the same target, if there are enough of them.
+     */
+    private sharedField(): DistanceField | undefined
+    {
+        if (this._sharedGeneration !== sharedFieldsGeneration)
+            this.joinSharedField();
+
+        const shared = this._shared;
+        if (!shared || shared.users < this.sharedFieldThreshold())
+            return undefined;
+
+        if (!shared.field) shared.field = new DistanceField();
+        return shared.field;
+    }
+
+    /**
+     * Counts this strategy as a user of the field shared by every strategy
+     * following the same target.
+     */
+    private joinSharedField(): void
+    {
+        this._shared = sharedFields.get(this._sharedKey) ?? { users: 0 };
+        this._shared.users++;
+        this._sharedGeneration = sharedFieldsGeneration;
+
+        sharedFields.set(this._sharedKey, this._shared);
+    }
+
+    /**
+     * Minimum number of strategies following the same target such that they
+     * should share a distance field rooted at it instead of searching on
+     * their own.
+     */
+    sharedFieldThreshold(): number
+    {
+        return 3;
+    }
+
+    /**
+     * Maximum distance from the target covered by a shared distance field.
+     * Strategies further away search on their own.
+     */
+    sharedFieldRadius(): number
+    {
+        return 64;
+    }
+
+    /**
+     * Whether to reuse paths found by earlier searches to the same target
+     * before searching again.
+     * 
+     * Only maps which own a persistent grid keep cached paths across
+     * searches.
+     */
+    pathCaching(): boolean
+    {
+        return true;
+    }
+
+    /**
+     * Whether to queue REA* searches to run in a batch at the end of the
+     * frame instead of running them immediately.
+     */
+    batched(): boolean
+    {
+        return true;
+    }
+
     /**
      * Minimum distance between points such that REA* should be applied.
      * 
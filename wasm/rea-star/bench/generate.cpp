@@ -0,0 +1,181 @@
+#include "generate.hpp"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using namespace rea_star;
+using namespace rea_star::bench;
+
+namespace {
+    using rng_t = std::mt19937;
+
+    int uniform(rng_t& rng, int min, int max) {
+        return std::uniform_int_distribution<int>(min, max)(rng);
+    }
+
+    void fill(Map& map, int left, int top, int right, int bottom, bool value) {
+        left = std::max(left, 0);
+        top = std::max(top, 0);
+        right = std::min(right, map.width - 1);
+        bottom = std::min(bottom, map.height - 1);
+
+        for (int y = top; y <= bottom; y++) {
+            for (int x = left; x <= right; x++) {
+                map.cells[x + y * map.width] = value;
+            }
+        }
+    }
+
+    void open(Map& map, rng_t& rng) {
+        fill(map, 0, 0, map.width - 1, map.height - 1, true);
+
+        int obstacles = map.width * map.height / 40;
+        for (int i = 0; i < obstacles; i++) {
+            int x = uniform(rng, 0, map.width - 1),
+                y = uniform(rng, 0, map.height - 1);
+
+            fill(map, x, y, x + uniform(rng, 0, 2), y + uniform(rng, 0, 2), false);
+        }
+    }
+
+    void split(Map& map, rng_t& rng, int left, int top, int right, int bottom) {
+        int width = right - left + 1,
+            height = bottom - top + 1;
+
+        constexpr int MIN_ROOM = 5;
+        bool vertical = width > height;
+        int span = vertical ? width : height;
+
+        if (span < 2 * MIN_ROOM + 1) return;
+
+        if (vertical) {
+            int x = uniform(rng, left + MIN_ROOM, right - MIN_ROOM);
+            fill(map, x, top, x, bottom, false);
+
+            int door = uniform(rng, top, bottom - 1);
+            fill(map, x, door, x, door + 1, true);
+
+            split(map, rng, left, top, x - 1, bottom);
+            split(map, rng, x + 1, top, right, bottom);
+        } else {
+            int y = uniform(rng, top + MIN_ROOM, bottom - MIN_ROOM);
+            fill(map, left, y, right, y, false);
+
+            int door = uniform(rng, left, right - 1);
+            fill(map, door, y, door + 1, y, true);
+
+            split(map, rng, left, top, right, y - 1);
+            split(map, rng, left, y + 1, right, bottom);
+        }
+    }
+
+    void rooms(Map& map, rng_t& rng) {
+        fill(map, 0, 0, map.width - 1, map.height - 1, true);
+        split(map, rng, 0, 0, map.width - 1, map.height - 1);
+    }
+
+    void corridors(Map& map, rng_t& rng) {
+        fill(map, 0, 0, map.width - 1, map.height - 1, false);
+
+        int junctions = std::max(2, map.width * map.height / 256);
+
+        int x = uniform(rng, 0, map.width - 1),
+            y = uniform(rng, 0, map.height - 1);
+
+        for (int i = 0; i < junctions; i++) {
+            int nx = uniform(rng, 0, map.width - 1),
+                ny = uniform(rng, 0, map.height - 1),
+                thickness = uniform(rng, 0, 1);
+
+            fill(map, std::min(x, nx), y, std::max(x, nx), y + thickness, true);
+            fill(map, nx, std::min(y, ny), nx + thickness, std::max(y, ny), true);
+
+            if (uniform(rng, 0, 3) == 0) {
+                int w = uniform(rng, 1, 3), h = uniform(rng, 1, 3);
+                fill(map, nx - w, ny - h, nx + w, ny + h, true);
+            }
+
+            x = nx;
+            y = ny;
+        }
+    }
+
+    void maze(Map& map, rng_t& rng) {
+        fill(map, 0, 0, map.width - 1, map.height - 1, false);
+
+        int columns = (map.width + 1) / 2,
+            rows = (map.height + 1) / 2;
+
+        std::vector<bool> visited(columns * rows, false);
+        std::vector<Point> stack { { .x = 0, .y = 0 } };
+
+        visited[0] = true;
+        map.cells[0] = true;
+
+        while (!stack.empty()) {
+            Point current = stack.back();
+
+            Point candidates[4];
+            int count = 0;
+
+            const Point steps[] = {
+                { .x = -1, .y = 0 }, { .x = 1, .y = 0 },
+                { .x = 0, .y = -1 }, { .x = 0, .y = 1 }
+            };
+
+            for (const Point& step : steps) {
+                Point next = { .x = current.x + step.x, .y = current.y + step.y };
+                if (next.x < 0 || next.y < 0) continue;
+                if (next.x >= columns || next.y >= rows) continue;
+                if (visited[next.x + next.y * columns]) continue;
+
+                candidates[count++] = next;
+            }
+
+            if (count == 0) {
+                stack.pop_back();
+                continue;
+            }
+
+            Point next = candidates[uniform(rng, 0, count - 1)];
+            visited[next.x + next.y * columns] = true;
+
+            fill(
+                map,
+                std::min(current.x, next.x) * 2,
+                std::min(current.y, next.y) * 2,
+                std::max(current.x, next.x) * 2,
+                std::max(current.y, next.y) * 2,
+                true
+            );
+
+            stack.push_back(next);
+        }
+    }
+};
+
+bool bench::generate(
+    const std::string& kind,
+    int width,
+    int height,
+    unsigned seed,
+    Map& map
+) {
+    map.name = kind + "-" + std::to_string(width) + "x" + std::to_string(height)
+        + "-" + std::to_string(seed);
+
+    map.width = width;
+    map.height = height;
+    map.cells.assign(width * height, 0);
+
+    rng_t rng(seed);
+
+    if (kind == "open") open(map, rng);
+    else if (kind == "rooms") rooms(map, rng);
+    else if (kind == "corridors") corridors(map, rng);
+    else if (kind == "maze") maze(map, rng);
+    else return false;
+
+    return true;
+}
@@ -0,0 +1,43 @@
+/**
+ * @file generate.hpp
+ * 
+ * @author Brandt
+ * @date 2020/10/11
+ * @license Zlib
+ * 
+ * Generators for RPG Maker-style benchmark maps.
+ */
+
+#pragma once
+
+#include <string>
+
+#include "map.hpp"
+
+namespace rea_star::bench {
+    /**
+     * Generates a map of a given kind.
+     * 
+     * Available kinds are:
+     * 
+     * - `open`: open field with scattered obstacles;
+     * - `rooms`: rooms of varying sizes connected by doors;
+     * - `corridors`: narrow corridors carved out of solid rock;
+     * - `maze`: perfect maze with single-tile corridors.
+     * 
+     * @param kind map kind.
+     * @param width map width.
+     * @param height map height.
+     * @param seed random seed.
+     * @param map receives the generated map.
+     * 
+     * @return whether the kind is known.
+     */
+    bool generate(
+        const std::string& kind,
+        int width,
+        int height,
+        unsigned seed,
+        Map& map
+    );
+};
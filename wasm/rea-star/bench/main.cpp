@@ -0,0 +1,603 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "algorithm/hierarchy.hpp"
+#include "algorithm/jump_point.hpp"
+#include "algorithm/rea_star.hpp"
+#include "algorithm/solver_pool.hpp"
+
+#include "generate.hpp"
+#include "map.hpp"
+#include "verify.hpp"
+
+using namespace rea_star;
+using namespace rea_star::bench;
+
+namespace {
+    /**
+     * Number of heap allocations made so far, to check that searches run
+     * without any once their solver is warm.
+     */
+    std::atomic<size_t> allocations = 0;
+};
+
+void* operator new(size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+
+    void* p = std::malloc(size == 0 ? 1 : size);
+    if (!p) std::abort();
+
+    return p;
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+    struct Suite {
+        Map map;
+        std::vector<Query> queries;
+    };
+
+    struct Summary {
+        int queries = 0;
+        int partial = 0;
+        double seconds = 0;
+
+        std::vector<double> latencies;
+        std::vector<double> expansions;
+        std::vector<double> merged;
+        std::vector<double> allocations;
+        std::vector<double> peak_open;
+        std::vector<double> probes;
+        std::vector<double> ratios;
+    };
+
+    /**
+     * REA* solver variants which can be benchmarked.
+     */
+    enum class Variant {
+        DEFAULT,
+        COMPLETE,
+        GREEDY
+    };
+
+    struct Options {
+        int queries = 1000;
+        int repeat = 1;
+        int maxlen = DEFAULT_PATH_MAXLEN;
+        int threads = 0;
+        bool clearance = false;
+        bool hierarchy = false;
+        bool jump_points = false;
+        bool verify = false;
+        Variant variant = Variant::DEFAULT;
+        unsigned seed = 1;
+        const char* json = nullptr;
+    };
+
+    double length(const path_t& path) {
+        double total = 0;
+        for (size_t i = 1; i < path.size(); i++) {
+            double dx = std::abs(path[i].x - path[i - 1].x),
+                   dy = std::abs(path[i].y - path[i - 1].y);
+
+            total += std::sqrt(2.0) * std::min(dx, dy) + std::abs(dx - dy);
+        }
+
+        return total;
+    }
+
+    double percentile(std::vector<double> values, double p) {
+        if (values.empty()) return 0;
+
+        std::sort(values.begin(), values.end());
+        size_t i = static_cast<size_t>(p * (values.size() - 1) + 0.5);
+        return values[i];
+    }
+
+    double mean(const std::vector<double>& values) {
+        if (values.empty()) return 0;
+
+        double total = 0;
+        for (double v : values) total += v;
+        return total / values.size();
+    }
+
+    size_t find_path(
+        const Query& query,
+        Grid<bool>& grid,
+        const Options& options,
+        path_t& path,
+        SearchStats& stats
+    ) {
+        if (options.jump_points) {
+            return jump_point_search(
+                query.source,
+                query.target,
+                grid,
+                path,
+                options.maxlen,
+                &stats
+            );
+        }
+
+        switch (options.variant) {
+        case Variant::COMPLETE:
+            return rectangle_expansion_astar<CompletePolicy>(
+                query.source,
+                query.target,
+                grid,
+                path,
+                options.maxlen,
+                &stats
+            );
+
+        case Variant::GREEDY:
+            return rectangle_expansion_astar<GreedyPolicy>(
+                query.source,
+                query.target,
+                grid,
+                path,
+                options.maxlen,
+                &stats
+            );
+
+        default:
+            return rectangle_expansion_astar(
+                query.source,
+                query.target,
+                grid,
+                path,
+                options.maxlen,
+                &stats
+            );
+        }
+    }
+
+    Summary run(const Suite& suite, const Options& options) {
+        using clock = std::chrono::steady_clock;
+
+        Grid<bool> grid(suite.map.width, suite.map.height, suite.map.cells);
+        if (options.clearance) grid.build_clearance();
+        Summary summary;
+
+        // Builds the jump distances up front and sizes the solver for the
+        // map, so that neither is timed.
+        path_t path;
+        if (!suite.queries.empty()) {
+            SearchStats stats;
+            find_path(suite.queries.front(), grid, options, path, stats);
+        }
+
+        for (int r = 0; r < options.repeat; r++) {
+            for (const Query& query : suite.queries) {
+                SearchStats stats;
+
+                size_t before = allocations.load(std::memory_order_relaxed);
+                auto start = clock::now();
+                find_path(query, grid, options, path, stats);
+                auto end = clock::now();
+
+                summary.allocations.push_back(
+                    allocations.load(std::memory_order_relaxed) - before
+                );
+
+                double seconds = std::chrono::duration<double>(end - start)
+                    .count();
+
+                summary.queries++;
+                summary.seconds += seconds;
+                summary.latencies.push_back(seconds * 1e6);
+                summary.expansions.push_back(stats.expansions);
+                summary.merged.push_back(stats.merged);
+                summary.peak_open.push_back(stats.peak_open);
+                summary.probes.push_back(stats.probes);
+
+                if (path.empty() || path.back() != query.target) {
+                    summary.partial++;
+                } else if (query.optimal > 0) {
+                    summary.ratios.push_back(length(path) / query.optimal);
+                }
+            }
+        }
+
+        return summary;
+    }
+
+    Summary run_pool(const Suite& suite, const Options& options) {
+        using clock = std::chrono::steady_clock;
+
+        Grid<bool> grid(suite.map.width, suite.map.height, suite.map.cells);
+        if (options.clearance) grid.build_clearance();
+        SolverPool pool(options.threads);
+        Summary summary;
+
+        std::vector<PathQuery> queries;
+        for (const Query& query : suite.queries) {
+            queries.push_back(PathQuery {
+                .source = query.source,
+                .target = query.target,
+                .maxlen = options.maxlen
+            });
+        }
+
+        PathBatch batch;
+        for (int r = 0; r < options.repeat; r++) {
+            auto start = clock::now();
+            pool.submit(queries, grid);
+            pool.collect(batch);
+            auto end = clock::now();
+
+            summary.queries += queries.size();
+            summary.seconds += std::chrono::duration<double>(end - start)
+                .count();
+
+            for (size_t i = 0; i < queries.size(); i++) {
+                path_t path(
+                    batch.points.begin() + batch.offsets[i],
+                    batch.points.begin() + batch.offsets[i + 1]
+                );
+
+                const Query& query = suite.queries[i];
+                if (path.empty() || path.back() != query.target) {
+                    summary.partial++;
+                } else if (query.optimal > 0) {
+                    summary.ratios.push_back(length(path) / query.optimal);
+                }
+            }
+        }
+
+        return summary;
+    }
+
+    Summary run_hierarchy(const Suite& suite, const Options& options) {
+        using clock = std::chrono::steady_clock;
+
+        Grid<bool> grid(suite.map.width, suite.map.height, suite.map.cells);
+        Hierarchy hierarchy;
+        Summary summary;
+
+        // Builds the abstraction up front, so that it is not timed.
+        path_t path;
+        if (!suite.queries.empty()) {
+            const Query& query = suite.queries.front();
+            hierarchy.find_waypoints(query.source, query.target, grid, path);
+        }
+
+        for (int r = 0; r < options.repeat; r++) {
+            for (const Query& query : suite.queries) {
+                path.clear();
+
+                auto start = clock::now();
+                hierarchy.find_path(query.source, query.target, grid, path);
+                auto end = clock::now();
+
+                double seconds = std::chrono::duration<double>(end - start)
+                    .count();
+
+                summary.queries++;
+                summary.seconds += seconds;
+                summary.latencies.push_back(seconds * 1e6);
+
+                if (path.empty() || path.back() != query.target) {
+                    summary.partial++;
+                } else if (query.optimal > 0) {
+                    summary.ratios.push_back(length(path) / query.optimal);
+                }
+            }
+        }
+
+        return summary;
+    }
+
+    void print(const Suite& suite, const Summary& summary) {
+        // Expansions are only counted on builds collecting search stats.
+        char expanded[16] = "-";
+        if (SEARCH_STATS_ENABLED) {
+            std::snprintf(
+                expanded,
+                sizeof(expanded),
+                "%.1f",
+                mean(summary.expansions)
+            );
+        }
+
+        std::printf(
+            "%-32s %8d %12.0f %10.2f %10.2f %10s %8.4f %8d\n",
+            suite.map.name.c_str(),
+            summary.queries,
+            summary.queries / summary.seconds,
+            percentile(summary.latencies, 0.5),
+            percentile(summary.latencies, 0.99),
+            expanded,
+            mean(summary.ratios),
+            summary.partial
+        );
+    }
+
+    void write_json(
+        FILE* out,
+        const std::vector<Suite>& suites,
+        const std::vector<Summary>& summaries
+    ) {
+        std::fprintf(out, "{\n  \"suites\": [");
+
+        for (size_t i = 0; i < suites.size(); i++) {
+            const Map& map = suites[i].map;
+            const Summary& s = summaries[i];
+
+            std::string name;
+            for (char c : map.name) {
+                if (c == '"' || c == '\\') name += '\\';
+                name += c;
+            }
+
+            std::fprintf(out, "%s\n    {\n", i == 0 ? "" : ",");
+            std::fprintf(out, "      \"name\": \"%s\",\n", name.c_str());
+            std::fprintf(out, "      \"width\": %d,\n", map.width);
+            std::fprintf(out, "      \"height\": %d,\n", map.height);
+            std::fprintf(out, "      \"queries\": %d,\n", s.queries);
+            std::fprintf(out, "      \"partial\": %d,\n", s.partial);
+            std::fprintf(out,
+                "      \"queries_per_second\": %.1f,\n", s.queries / s.seconds);
+
+            std::fprintf(out,
+                "      \"latency_us\": "
+                "{ \"mean\": %.3f, \"p50\": %.3f, \"p99\": %.3f },\n",
+                mean(s.latencies),
+                percentile(s.latencies, 0.5),
+                percentile(s.latencies, 0.99));
+
+            std::fprintf(out,
+                "      \"allocations\": { \"mean\": %.2f, \"p99\": %.0f },\n",
+                mean(s.allocations),
+                percentile(s.allocations, 0.99));
+
+            if (SEARCH_STATS_ENABLED) {
+                std::fprintf(out,
+                    "      \"expansions\": "
+                    "{ \"mean\": %.2f, \"p50\": %.0f, \"p99\": %.0f },\n",
+                    mean(s.expansions),
+                    percentile(s.expansions, 0.5),
+                    percentile(s.expansions, 0.99));
+
+                std::fprintf(out,
+                    "      \"merged\": { \"mean\": %.2f, \"p99\": %.0f },\n",
+                    mean(s.merged),
+                    percentile(s.merged, 0.99));
+
+                std::fprintf(out,
+                    "      \"peak_open\": { \"mean\": %.2f, \"p99\": %.0f },\n",
+                    mean(s.peak_open),
+                    percentile(s.peak_open, 0.99));
+
+                std::fprintf(out,
+                    "      \"probes\": { \"mean\": %.2f, \"p99\": %.0f },\n",
+                    mean(s.probes),
+                    percentile(s.probes, 0.99));
+            }
+
+            std::fprintf(out,
+                "      \"path_ratio\": "
+                "{ \"mean\": %.5f, \"p50\": %.5f, \"p99\": %.5f }\n",
+                mean(s.ratios),
+                percentile(s.ratios, 0.5),
+                percentile(s.ratios, 0.99));
+
+            std::fprintf(out, "    }");
+        }
+
+        std::fprintf(out, "\n  ]\n}\n");
+    }
+
+    [[noreturn]]
+    void usage(const char* program) {
+        std::fprintf(stderr,
+            "usage: %s [options]\n"
+            "\n"
+            "  --map FILE          Moving AI map, with random queries unless\n"
+            "                      followed by --scen\n"
+            "  --scen FILE         Moving AI scenario for the last map\n"
+            "  --generate KIND[:WxH]\n"
+            "                      generated map (open, rooms, corridors,\n"
+            "                      maze), 128x128 by default\n"
+            "  --queries N         random queries per map (default 1000)\n"
+            "  --repeat N          times to run each query (default 1)\n"
+            "  --maxlen N          maximum path length\n"
+            "  --clearance         index cell clearance before running\n"
+            "  --hierarchy         use the hierarchical search, built before\n"
+            "                      running\n"
+            "  --jps               use JPS+, with jump distances computed\n"
+            "                      before running\n"
+            "  --policy NAME       REA* solver variant: default, complete\n"
+            "                      (no partial paths nor maximum length)\n"
+            "                      or greedy (Manhattan\n"
+            "                      heuristic, integer lengths)\n"
+            "  --verify            check the paths of every engine instead of\n"
+            "                      timing them, failing if any is wrong\n"
+            "  --threads N         run queries in batches on a pool of N\n"
+            "                      threads, measuring throughput only\n"
+            "  --seed N            random seed (default 1), applied to the\n"
+            "                      maps generated after it\n"
+            "  --json FILE         write results as JSON\n"
+            "\n"
+            "Without maps, all generated kinds are used.\n",
+            program);
+
+        std::exit(EXIT_FAILURE);
+    }
+};
+
+int main(int argc, char** argv) {
+    Options options;
+    std::vector<Suite> suites;
+    std::vector<bool> scenario;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+
+        if (std::strcmp(arg, "--help") == 0) usage(argv[0]);
+
+        if (std::strcmp(arg, "--clearance") == 0) {
+            options.clearance = true;
+            continue;
+        }
+
+        if (std::strcmp(arg, "--hierarchy") == 0) {
+            options.hierarchy = true;
+            continue;
+        }
+
+        if (std::strcmp(arg, "--jps") == 0) {
+            options.jump_points = true;
+            continue;
+        }
+
+        if (std::strcmp(arg, "--verify") == 0) {
+            options.verify = true;
+            continue;
+        }
+
+        if (!value) usage(argv[0]);
+        i++;
+
+        if (std::strcmp(arg, "--map") == 0) {
+            Suite suite;
+            if (!load_map(value, suite.map)) {
+                std::fprintf(stderr, "could not load map %s\n", value);
+                return EXIT_FAILURE;
+            }
+
+            suites.push_back(std::move(suite));
+            scenario.push_back(false);
+        } else if (std::strcmp(arg, "--scen") == 0) {
+            if (suites.empty()) usage(argv[0]);
+
+            if (!load_scenario(value, suites.back().queries)) {
+                std::fprintf(stderr, "could not load scenario %s\n", value);
+                return EXIT_FAILURE;
+            }
+
+            scenario.back() = true;
+        } else if (std::strcmp(arg, "--generate") == 0) {
+            std::string kind = value;
+            int width = 128, height = 128;
+
+            size_t colon = kind.find(':');
+            if (colon != std::string::npos) {
+                if (std::sscanf(kind.c_str() + colon + 1, "%dx%d", &width, &height) != 2) {
+                    usage(argv[0]);
+                }
+
+                kind.resize(colon);
+            }
+
+            Suite suite;
+            if (!generate(kind, width, height, options.seed, suite.map)) {
+                std::fprintf(stderr, "unknown map kind %s\n", kind.c_str());
+                return EXIT_FAILURE;
+            }
+
+            suites.push_back(std::move(suite));
+            scenario.push_back(false);
+        }
+        else if (std::strcmp(arg, "--queries") == 0) options.queries = std::atoi(value);
+        else if (std::strcmp(arg, "--repeat") == 0) options.repeat = std::atoi(value);
+        else if (std::strcmp(arg, "--maxlen") == 0) options.maxlen = std::atoi(value);
+        else if (std::strcmp(arg, "--threads") == 0) options.threads = std::atoi(value);
+        else if (std::strcmp(arg, "--seed") == 0) options.seed = std::atoi(value);
+        else if (std::strcmp(arg, "--json") == 0) options.json = value;
+        else if (std::strcmp(arg, "--policy") == 0) {
+            if (std::strcmp(value, "default") == 0) {
+                options.variant = Variant::DEFAULT;
+            } else if (std::strcmp(value, "complete") == 0) {
+                options.variant = Variant::COMPLETE;
+            } else if (std::strcmp(value, "greedy") == 0) {
+                options.variant = Variant::GREEDY;
+            } else {
+                usage(argv[0]);
+            }
+        }
+        else usage(argv[0]);
+    }
+
+    if (suites.empty()) {
+        for (const char* kind : { "open", "rooms", "corridors", "maze" }) {
+            Suite suite;
+            generate(kind, 128, 128, options.seed, suite.map);
+
+            suites.push_back(std::move(suite));
+            scenario.push_back(false);
+        }
+    }
+
+    for (size_t i = 0; i < suites.size(); i++) {
+        if (scenario[i]) continue;
+
+        suites[i].queries = random_queries(
+            suites[i].map,
+            options.queries,
+            options.seed
+        );
+    }
+
+    if (options.verify) {
+        std::printf("%-32s %8s %8s\n", "map", "queries", "failures");
+
+        int failures = 0;
+        for (const Suite& suite : suites) {
+            int failed = verify(suite.map, suite.queries, options.seed);
+            failures += failed;
+
+            std::printf(
+                "%-32s %8zu %8d\n",
+                suite.map.name.c_str(),
+                suite.queries.size(),
+                failed
+            );
+        }
+
+        return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    std::printf(
+        "%-32s %8s %12s %10s %10s %10s %8s %8s\n",
+        "map", "queries", "queries/s", "p50 (us)", "p99 (us)",
+        "expanded", "ratio", "partial"
+    );
+
+    std::vector<Summary> summaries;
+    for (const Suite& suite : suites) {
+        if (options.hierarchy) summaries.push_back(run_hierarchy(suite, options));
+        else if (options.threads > 0) summaries.push_back(run_pool(suite, options));
+        else summaries.push_back(run(suite, options));
+        print(suite, summaries.back());
+    }
+
+    if (options.json) {
+        FILE* out = std::fopen(options.json, "w");
+        if (!out) {
+            std::fprintf(stderr, "could not write %s\n", options.json);
+            return EXIT_FAILURE;
+        }
+
+        write_json(out, suites, summaries);
+        std::fclose(out);
+    }
+
+    return EXIT_SUCCESS;
+}
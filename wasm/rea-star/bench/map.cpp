@@ -0,0 +1,191 @@
+#include "map.hpp"
+
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <random>
+#include <sstream>
+
+using namespace rea_star;
+using namespace rea_star::bench;
+
+bool bench::load_map(const std::string& path, Map& map) {
+    std::ifstream in(path);
+    if (!in) return false;
+
+    map.name = path;
+    map.width = map.height = 0;
+
+    std::string key;
+    while (in >> key && key != "map") {
+        if (key == "width") in >> map.width;
+        else if (key == "height") in >> map.height;
+        else in.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+    }
+
+    if (map.width <= 0 || map.height <= 0) return false;
+
+    map.cells.assign(map.width * map.height, 0);
+
+    std::string row;
+    for (int y = 0; y < map.height; y++) {
+        if (!(in >> row) || static_cast<int>(row.size()) < map.width) {
+            return false;
+        }
+
+        for (int x = 0; x < map.width; x++) {
+            char c = row[x];
+            map.cells[x + y * map.width] = c == '.' || c == 'G' || c == 'S';
+        }
+    }
+
+    return true;
+}
+
+bool bench::load_scenario(const std::string& path, std::vector<Query>& queries) {
+    std::ifstream in(path);
+    if (!in) return false;
+
+    std::string line;
+    std::getline(in, line);
+    if (line.rfind("version", 0) != 0) return false;
+
+    while (std::getline(in, line)) {
+        std::istringstream fields(line);
+
+        int bucket, width, height;
+        std::string map;
+        Query query;
+
+        fields >> bucket >> map >> width >> height
+            >> query.source.x >> query.source.y
+            >> query.target.x >> query.target.y
+            >> query.optimal;
+
+        if (fields) queries.push_back(query);
+    }
+
+    return true;
+}
+
+std::vector<Query> bench::random_queries(
+    const Map& map,
+    int count,
+    unsigned seed
+) {
+    std::vector<int> component(map.width * map.height, -1);
+    std::vector<int> free;
+
+    int components = 0;
+    for (int i = 0; i < map.width * map.height; i++) {
+        if (!map.cells[i]) continue;
+        free.push_back(i);
+
+        if (component[i] >= 0) continue;
+
+        std::queue<int> open;
+        open.push(i);
+        component[i] = components;
+
+        while (!open.empty()) {
+            int j = open.front();
+            open.pop();
+
+            int x = j % map.width, y = j / map.width;
+            const Point neighbors[] = {
+                { .x = x - 1, .y = y }, { .x = x + 1, .y = y },
+                { .x = x, .y = y - 1 }, { .x = x, .y = y + 1 }
+            };
+
+            for (const Point& n : neighbors) {
+                int k = n.x + n.y * map.width;
+                if (!map.free(n.x, n.y) || component[k] >= 0) continue;
+
+                component[k] = components;
+                open.push(k);
+            }
+        }
+
+        components++;
+    }
+
+    std::vector<Query> queries;
+    if (free.empty()) return queries;
+
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<size_t> pick(0, free.size() - 1);
+
+    for (
+        int attempts = 0;
+        static_cast<int>(queries.size()) < count && attempts < count * 100;
+        attempts++
+    ) {
+        int s = free[pick(rng)], t = free[pick(rng)];
+        if (s == t || component[s] != component[t]) continue;
+
+        Point source = { .x = s % map.width, .y = s / map.width },
+              target = { .x = t % map.width, .y = t / map.width };
+
+        queries.push_back(Query {
+            .source = source,
+            .target = target,
+            .optimal = optimal_length(map, source, target)
+        });
+    }
+
+    return queries;
+}
+
+double bench::optimal_length(const Map& map, Point source, Point target) {
+    const double sqrt2 = std::sqrt(2.0);
+
+    auto heuristic = [&](int x, int y) {
+        double dx = std::abs(x - target.x), dy = std::abs(y - target.y);
+        return sqrt2 * std::min(dx, dy) + std::abs(dx - dy);
+    };
+
+    using entry_t = std::pair<double, int>;
+    std::priority_queue<entry_t, std::vector<entry_t>, std::greater<entry_t>>
+        open;
+
+    std::vector<double> g(map.width * map.height, INFINITY);
+
+    int s = source.x + source.y * map.width,
+        t = target.x + target.y * map.width;
+
+    g[s] = 0;
+    open.push({ heuristic(source.x, source.y), s });
+
+    while (!open.empty()) {
+        auto [f, i] = open.top();
+        open.pop();
+
+        if (i == t) return g[t];
+
+        int x = i % map.width, y = i / map.width;
+        if (f - heuristic(x, y) > g[i] + 1e-9) continue;
+
+        for (int dy = -1; dy <= 1; dy++) {
+            for (int dx = -1; dx <= 1; dx++) {
+                if (dx == 0 && dy == 0) continue;
+                if (!map.free(x + dx, y + dy)) continue;
+
+                if (dx != 0 && dy != 0
+                    && (!map.free(x + dx, y) || !map.free(x, y + dy))) {
+                    continue;
+                }
+
+                int j = (x + dx) + (y + dy) * map.width;
+                double gj = g[i] + (dx != 0 && dy != 0 ? sqrt2 : 1);
+                if (gj >= g[j]) continue;
+
+                g[j] = gj;
+                open.push({ gj + heuristic(x + dx, y + dy), j });
+            }
+        }
+    }
+
+    return -1;
+}
@@ -0,0 +1,86 @@
+/**
+ * @file map.hpp
+ * 
+ * @author Brandt
+ * @date 2020/10/11
+ * @license Zlib
+ * 
+ * Benchmark maps and queries.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "data/grid.hpp"
+
+namespace rea_star::bench {
+    /**
+     * Boolean map, stored row-major with one byte per cell (non-zero for
+     * free).
+     */
+    struct Map {
+        std::string name;
+        int width;
+        int height;
+        std::vector<uint8_t> cells;
+
+        bool free(int x, int y) const {
+            return x >= 0 && y >= 0 && x < width && y < height
+                && cells[x + y * width];
+        }
+    };
+
+    /**
+     * Path query, along with the length of an optimal 8-connected path.
+     */
+    struct Query {
+        Point source;
+        Point target;
+        double optimal;
+    };
+
+    /**
+     * Loads a map in the Moving AI format.
+     * 
+     * @param path path to the `.map` file.
+     * @param map receives the loaded map.
+     * 
+     * @return whether the map could be loaded.
+     */
+    bool load_map(const std::string& path, Map& map);
+
+    /**
+     * Loads the queries in a Moving AI scenario.
+     * 
+     * @param path path to the `.scen` file.
+     * @param queries receives the loaded queries.
+     * 
+     * @return whether the scenario could be loaded.
+     */
+    bool load_scenario(const std::string& path, std::vector<Query>& queries);
+
+    /**
+     * Picks random queries between connected free cells of a map, along with
+     * their optimal lengths.
+     * 
+     * @param map boolean map.
+     * @param count number of queries.
+     * @param seed random seed.
+     */
+    std::vector<Query> random_queries(const Map& map, int count, unsigned seed);
+
+    /**
+     * Finds the length of the shortest 8-connected path between two cells,
+     * where diagonal moves may not cut corners.
+     * 
+     * @param map boolean map.
+     * @param source starting cell.
+     * @param target goal cell.
+     * 
+     * @return the path length, or a negative value if there is no path.
+     */
+    double optimal_length(const Map& map, Point source, Point target);
+};
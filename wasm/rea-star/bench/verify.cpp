@@ -0,0 +1,1065 @@
+#include "verify.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <queue>
+#include <random>
+
+#include "algorithm/distance_field.hpp"
+#include "algorithm/grid_astar.hpp"
+#include "algorithm/hierarchy.hpp"
+#include "algorithm/jump_point.hpp"
+#include "algorithm/path_cache.hpp"
+#include "algorithm/rea_star.hpp"
+#include "algorithm/weighted_rea_star.hpp"
+
+using namespace rea_star;
+using namespace rea_star::bench;
+
+namespace {
+    /**
+     * Radius of the distance fields checked.
+     */
+    constexpr int FIELD_RADIUS = 64;
+
+    /**
+     * Number of targets given to each nearest target search.
+     */
+    constexpr int NEAREST_TARGETS = 4;
+
+    /**
+     * Width and height of the patches of equal cost on weighted maps.
+     */
+    constexpr int PATCH_SIZE = 8;
+
+    /**
+     * Number of random updates made to the grids.
+     */
+    constexpr int UPDATES = 200;
+
+    /**
+     * Tolerance when comparing path lengths.
+     */
+    constexpr double EPSILON = 1e-3;
+
+    /**
+     * Failures printed for each map, after which they are only counted.
+     */
+    constexpr int MAX_REPORTS = 20;
+
+    /**
+     * Searches kept across queries, so that their cached state is checked
+     * too.
+     */
+    struct Engines {
+        REAStarSolver solver;
+        JumpPointSolver jump_points;
+        GridAStarSolver astar;
+        Hierarchy hierarchy;
+        PathCache cache;
+        DistanceField field;
+    };
+
+    struct Report {
+        const Map& map;
+        int failures = 0;
+
+        void fail(
+            const char* engine,
+            const char* check,
+            const Point& source,
+            const Point& target
+        ) {
+            if (failures++ >= MAX_REPORTS) return;
+
+            std::printf(
+                "%s: %s %s from (%d, %d) to (%d, %d)\n",
+                map.name.c_str(),
+                engine,
+                check,
+                source.x,
+                source.y,
+                target.x,
+                target.y
+            );
+        }
+    };
+
+    /**
+     * @return the length of a path, with diagonal steps costing `diagonal`.
+     */
+    double length(const path_t& path, double diagonal = 1.414) {
+        double total = 0;
+        for (size_t i = 1; i < path.size(); i++) {
+            double dx = std::abs(path[i].x - path[i - 1].x),
+                   dy = std::abs(path[i].y - path[i - 1].y);
+
+            total += diagonal * std::min(dx, dy) + std::abs(dx - dy);
+        }
+
+        return total;
+    }
+
+    /**
+     * @return the number of orthogonal steps taken to walk a path.
+     */
+    int walk_length(const path_t& path) {
+        int total = 0;
+        for (size_t i = 1; i < path.size(); i++) {
+            total += std::abs(path[i].x - path[i - 1].x)
+                + std::abs(path[i].y - path[i - 1].y);
+        }
+
+        return total;
+    }
+
+    /**
+     * @return whether a segment can be walked one orthogonal step at a time
+     *         towards its end, on free tiles only. The tile it starts on may
+     *         be blocked, like those taken by characters searching.
+     */
+    bool walkable(const Map& map, const Point& a, const Point& b) {
+        int sx = b.x >= a.x ? 1 : -1,
+            sy = b.y >= a.y ? 1 : -1;
+
+        int width = std::abs(b.x - a.x) + 1,
+            height = std::abs(b.y - a.y) + 1;
+
+        // Whether each cell on the current row of the segment's box can be
+        // reached from its start.
+        std::vector<bool> reached(width, false);
+        for (int j = 0; j < height; j++) {
+            for (int i = 0; i < width; i++) {
+                bool start = i == 0 && j == 0;
+                bool from = start
+                    || (i > 0 && reached[i - 1])
+                    || (j > 0 && reached[i]);
+
+                reached[i] = from
+                    && (start || map.free(a.x + sx * i, a.y + sy * j));
+            }
+        }
+
+        return reached[width - 1];
+    }
+
+    /**
+     * Checks that a path starts on its source, can be walked, and ends on its
+     * target if it must.
+     * 
+     * @return whether the path is complete and valid.
+     */
+    bool check(
+        Report& report,
+        const Map& map,
+        const char* engine,
+        const path_t& path,
+        const Point& source,
+        const Point& target,
+        bool reachable
+    ) {
+        if (path.empty()) {
+            if (reachable) {
+                report.fail(engine, "found no path", source, target);
+            }
+
+            return false;
+        }
+
+        if (path.front() != source) {
+            report.fail(engine, "path misses source", source, target);
+            return false;
+        }
+
+        for (size_t i = 1; i < path.size(); i++) {
+            if (!walkable(map, path[i - 1], path[i])) {
+                report.fail(engine, "path is blocked", source, target);
+                return false;
+            }
+        }
+
+        if (path.back() != target) {
+            if (reachable) {
+                report.fail(engine, "path is partial", source, target);
+            }
+
+            return false;
+        }
+
+        return true;
+    }
+
+    /**
+     * Checks nearest target searches, each from the source of a query to its
+     * target and those of the next few queries. Paths must end on one of the
+     * targets whenever one can be reached, and be no longer than the shortest
+     * REA* path to any of them.
+     */
+    void check_nearest(
+        Report& report,
+        const Map& map,
+        const std::vector<Query>& queries,
+        Grid<bool>& g
+    ) {
+        std::vector<Point> targets;
+        path_t path, single;
+
+        for (size_t i = 0; i < queries.size(); i++) {
+            const Point& source = queries[i].source;
+
+            targets.clear();
+            bool reachable = false;
+            double shortest = INFINITY;
+
+            for (size_t j = 0; j < NEAREST_TARGETS; j++) {
+                const Query& query = queries[(i + j) % queries.size()];
+                const Point& target = query.target;
+
+                targets.push_back(target);
+                reachable |= query.optimal >= 0;
+
+                rectangle_expansion_astar(source, target, g, single);
+                if (!single.empty() && single.back() == target) {
+                    shortest = std::min(shortest, length(single));
+                }
+            }
+
+            rectangle_expansion_astar_nearest(source, targets, g, path);
+
+            // Partial paths end on the closest point found instead.
+            const Point& end = path.empty() ? source : path.back();
+            auto target = std::find(targets.begin(), targets.end(), end);
+
+            if (target == targets.end()) {
+                if (reachable) {
+                    report.fail(
+                        "REA* (nearest)",
+                        "misses every target",
+                        source,
+                        end
+                    );
+                }
+
+                continue;
+            }
+
+            if (!check(
+                report,
+                map,
+                "REA* (nearest)",
+                path,
+                source,
+                end,
+                true
+            )) continue;
+
+            if (length(path) > shortest + EPSILON) {
+                report.fail(
+                    "REA* (nearest)",
+                    "path ends on a farther target",
+                    source,
+                    end
+                );
+            }
+        }
+    }
+
+    /**
+     * @return the cost of every cell of a map, in square patches of random
+     *         costs like roads, grass and swamps, or zero for blocked cells.
+     */
+    std::vector<uint8_t> patch_costs(const Map& map, unsigned seed) {
+        static constexpr uint8_t COSTS[] = { 1, 1, 2, 3, 5 };
+
+        std::mt19937 rng(seed);
+        auto random = [&rng](int limit) {
+            return std::uniform_int_distribution<int>(0, limit - 1)(rng);
+        };
+
+        int columns = (map.width + PATCH_SIZE - 1) / PATCH_SIZE,
+            rows = (map.height + PATCH_SIZE - 1) / PATCH_SIZE;
+
+        std::vector<uint8_t> patches(columns * rows);
+        for (uint8_t& patch : patches) patch = COSTS[random(std::size(COSTS))];
+
+        std::vector<uint8_t> costs(map.width * map.height, 0);
+        for (int y = 0; y < map.height; y++) {
+            for (int x = 0; x < map.width; x++) {
+                if (!map.free(x, y)) continue;
+
+                costs[x + y * map.width] = patches[
+                    x / PATCH_SIZE + y / PATCH_SIZE * columns
+                ];
+            }
+        }
+
+        return costs;
+    }
+
+    /**
+     * @return the cost of the cheapest path between two cells of a weighted
+     *         map, or -1 if there is none. Moving into a cell costs its cost
+     *         times the length of the step, and diagonal steps need either
+     *         orthogonal route to be free, as on REA*.
+     */
+    double cheapest_cost(
+        const Map& map,
+        const std::vector<uint8_t>& costs,
+        const Point& source,
+        const Point& target
+    ) {
+        using entry_t = std::pair<double, int>;
+        std::priority_queue<
+            entry_t,
+            std::vector<entry_t>,
+            std::greater<entry_t>
+        > open;
+
+        std::vector<double> g(map.width * map.height, INFINITY);
+
+        int s = source.x + source.y * map.width,
+            t = target.x + target.y * map.width;
+
+        g[s] = 0;
+        open.push({ 0, s });
+
+        while (!open.empty()) {
+            auto [d, i] = open.top();
+            open.pop();
+
+            if (i == t) return d;
+            if (d > g[i]) continue;
+
+            int x = i % map.width, y = i / map.width;
+            for (int dy = -1; dy <= 1; dy++) {
+                for (int dx = -1; dx <= 1; dx++) {
+                    if (dx == 0 && dy == 0) continue;
+                    if (!map.free(x + dx, y + dy)) continue;
+
+                    bool diagonal = dx != 0 && dy != 0;
+                    if (
+                        diagonal
+                        && !map.free(x + dx, y)
+                        && !map.free(x, y + dy)
+                    ) continue;
+
+                    int j = (x + dx) + (y + dy) * map.width;
+                    double gj = d + costs[j] * (diagonal ? 1.414 : 1);
+                    if (gj >= g[j] - 1e-9) continue;
+
+                    g[j] = gj;
+                    open.push({ gj, j });
+                }
+            }
+        }
+
+        return -1;
+    }
+
+    /**
+     * Checks weighted REA* paths on a weighted copy of a map against the
+     * cheapest paths found by Dijkstra's algorithm. Paths may cost more than
+     * those, but never less.
+     */
+    void check_weighted(
+        Report& report,
+        const Map& map,
+        const std::vector<Query>& queries,
+        unsigned seed
+    ) {
+        std::vector<uint8_t> costs = patch_costs(map, seed);
+        Grid<uint8_t> g(map.width, map.height, costs);
+
+        WeightedREAStarSolver solver;
+        path_t path;
+
+        for (const Query& query : queries) {
+            const Point& source = query.source;
+            const Point& target = query.target;
+
+            double cheapest = cheapest_cost(map, costs, source, target);
+
+            path.clear();
+            solver.find_path(source, target, g, path);
+            if (!check(
+                report,
+                map,
+                "weighted REA*",
+                path,
+                source,
+                target,
+                cheapest >= 0
+            )) continue;
+
+            double cost = 0;
+            for (size_t i = 1; i < path.size(); i++) {
+                const Point& p = path[i];
+                cost += costs[p.x + p.y * map.width] * octile(path[i - 1], p);
+            }
+
+            if (cost < cheapest - EPSILON) {
+                report.fail(
+                    "weighted REA*",
+                    "path is cheaper than the cheapest one",
+                    source,
+                    target
+                );
+            }
+        }
+    }
+
+    /**
+     * @return a map repeating another one along each axis it loops on.
+     */
+    Map tile(const Map& map, Topology topology, int copies) {
+        int columns = topology.loop_x ? copies : 1,
+            rows = topology.loop_y ? copies : 1;
+
+        Map tiled = {
+            .name = map.name,
+            .width = map.width * columns,
+            .height = map.height * rows,
+            .cells = {}
+        };
+
+        tiled.cells.resize(size_t(tiled.width) * tiled.height);
+        for (int y = 0; y < tiled.height; y++) {
+            for (int x = 0; x < tiled.width; x++) {
+                tiled.cells[x + y * tiled.width] = map.cells[
+                    x % map.width + y % map.height * map.width
+                ];
+            }
+        }
+
+        return tiled;
+    }
+
+    /**
+     * Maps a path on a looping map onto the middle copy of the tiled map,
+     * moving from each point to the nearest copy of the next one, as
+     * characters do.
+     */
+    path_t lift(const Map& map, Topology topology, const path_t& path) {
+        auto nearest = [](int delta, int size, bool loops) {
+            if (!loops) return delta;
+
+            delta = (delta % size + size) % size;
+            return delta > size / 2 ? delta - size : delta;
+        };
+
+        path_t lifted;
+        for (const Point& p : path) {
+            if (lifted.empty()) {
+                lifted.push_back(Point {
+                    .x = p.x + (topology.loop_x ? map.width : 0),
+                    .y = p.y + (topology.loop_y ? map.height : 0)
+                });
+
+                continue;
+            }
+
+            Point a = lifted.back();
+            lifted.push_back(Point {
+                .x = a.x + nearest(p.x - a.x, map.width, topology.loop_x),
+                .y = a.y + nearest(p.y - a.y, map.height, topology.loop_y)
+            });
+        }
+
+        return lifted;
+    }
+
+    /**
+     * @return the number of orthogonal steps on the shortest path from a
+     *         cell to every cell of a map, or -1 for those out of reach.
+     */
+    std::vector<int> steps_from(
+        const Map& map,
+        Topology topology,
+        const Point& source
+    ) {
+        std::vector<int> steps(map.width * map.height, -1);
+        std::vector<Point> queue = { source };
+
+        steps[source.x + source.y * map.width] = 0;
+
+        for (size_t i = 0; i < queue.size(); i++) {
+            Point p = queue[i];
+            int distance = steps[p.x + p.y * map.width];
+
+            for (Cardinal cardinal : CARDINALS) {
+                Point q = p;
+                (axis(cardinal) == Axis::X ? q.x : q.y) += step(cardinal);
+
+                if (topology.loop_x) q.x = (q.x + map.width) % map.width;
+                if (topology.loop_y) q.y = (q.y + map.height) % map.height;
+
+                if (!map.free(q.x, q.y)) continue;
+
+                int& qsteps = steps[q.x + q.y * map.width];
+                if (qsteps >= 0) continue;
+
+                qsteps = distance + 1;
+                queue.push_back(q);
+            }
+        }
+
+        return steps;
+    }
+
+    /**
+     * Checks the paths of every engine for a query on a looping map.
+     * 
+     * @param window copies of the map held by its grid.
+     * @param tiled map tiled three times along the axes it loops on.
+     * @param g looping grid of the map.
+     */
+    void check_looping(
+        Report& report,
+        const Map& map,
+        const Map& window,
+        const Map& tiled,
+        const Query& query,
+        Grid<bool>& g,
+        Engines& engines
+    ) {
+        const Point& source = query.source;
+        const Point& target = query.target;
+
+        Topology topology = g.topology();
+
+        // Searches only cross the copies of the map around the source held
+        // by the grid, so they may miss routes going the long way around.
+        int steps = steps_from(map, topology, source)[
+            target.x + target.y * map.width
+        ];
+
+        std::vector<int> window_steps = steps_from(
+            window,
+            Topology {},
+            g.unwrap(source)
+        );
+
+        int shortest = -1;
+        g.for_each_image(target, [&](const Point& p) {
+            int image = window_steps[p.x + p.y * window.width];
+            if (image >= 0 && (shortest < 0 || image < shortest)) {
+                shortest = image;
+            }
+        });
+
+        bool reachable = shortest >= 0;
+
+        // Paths come back in map coordinates, and are walked across the
+        // edges of the map towards the nearest copy of each point.
+        auto check_engine = [&](const char* engine, const path_t& path) {
+            if (path.empty()) {
+                if (reachable) {
+                    report.fail(engine, "found no path", source, target);
+                }
+
+                return false;
+            }
+
+            if (path.front() != source) {
+                report.fail(engine, "path misses source", source, target);
+                return false;
+            }
+
+            path_t lifted = lift(map, topology, path);
+            for (size_t i = 1; i < lifted.size(); i++) {
+                if (!walkable(tiled, lifted[i - 1], lifted[i])) {
+                    report.fail(engine, "path is blocked", source, target);
+                    return false;
+                }
+            }
+
+            if (path.back() != target) {
+                if (reachable) {
+                    report.fail(engine, "path is partial", source, target);
+                }
+
+                return false;
+            }
+
+            if (walk_length(lifted) < steps) {
+                report.fail(engine, "walks less than A*", source, target);
+            }
+
+            return true;
+        };
+
+        path_t path;
+        engines.astar.find_path(source, target, g, path);
+        if (check_engine("A*", path) && int(path.size()) - 1 != shortest) {
+            report.fail("A*", "path is not optimal", source, target);
+        }
+
+        rectangle_expansion_astar(source, target, g, path);
+        check_engine("REA*", path);
+
+        // The other engines don't search across the edges of the map.
+        path.clear();
+        if (engines.jump_points.find_path(source, target, g, path) != 0) {
+            report.fail("JPS+", "searches a looping map", source, target);
+        }
+
+        path.clear();
+        if (engines.hierarchy.find_path(source, target, g, path) != 0) {
+            report.fail("HPA*", "searches a looping map", source, target);
+        }
+
+        path.clear();
+        if (engines.field.find_path(source, target, g, path, FIELD_RADIUS)) {
+            report.fail("field", "searches a looping map", source, target);
+        }
+    }
+
+    /**
+     * Checks the paths of the engines meant to lead characters out of the
+     * blocked tiles they stand on, for a query whose source is blocked.
+     * 
+     * @param occupied map with the source of the query blocked.
+     * @param g grid of the map.
+     */
+    void check_occupied(
+        Report& report,
+        const Map& occupied,
+        const Query& query,
+        Grid<bool>& g,
+        Engines& engines
+    ) {
+        const Point& source = query.source;
+        const Point& target = query.target;
+
+        double optimal = optimal_length(occupied, source, target);
+
+        path_t path;
+        engines.hierarchy.find_path(source, target, g, path);
+        check(report, occupied, "HPA*", path, source, target, optimal >= 0);
+
+        DistanceField& field = engines.field;
+
+        path.clear();
+        if (field.find_path(source, target, g, path, FIELD_RADIUS) == 0) {
+            if (optimal >= 0 && optimal <= FIELD_RADIUS - EPSILON) {
+                report.fail("field", "misses occupied source", source, target);
+            }
+
+            return;
+        }
+
+        if (!check(report, occupied, "field", path, source, target, true)) {
+            return;
+        }
+
+        double exact = length(path, std::sqrt(2.0));
+        if (exact < optimal - EPSILON || exact > optimal * (1 + EPSILON)) {
+            report.fail(
+                "field",
+                "path from occupied source is not optimal",
+                source,
+                target
+            );
+        }
+    }
+
+    /**
+     * Checks the paths of every engine for a query on an unchanged map.
+     */
+    void check_query(
+        Report& report,
+        const Map& map,
+        const Query& query,
+        Grid<bool>& grid,
+        Grid<bool>& indexed,
+        Engines& engines
+    ) {
+        const Point& source = query.source;
+        const Point& target = query.target;
+        bool reachable = query.optimal >= 0;
+
+        path_t reference, path, other;
+
+        // Plain A* walks the fewest tiles, so no other path may be shorter
+        // once walked one orthogonal step at a time.
+        engines.astar.find_path(source, target, grid, other);
+        check(report, map, "A*", other, source, target, reachable);
+
+        int steps = walk_length(other);
+
+        auto check_engine = [&](const char* engine, const path_t& path) {
+            bool complete = check(
+                report, map, engine, path, source, target, reachable
+            );
+
+            if (complete && walk_length(path) < steps) {
+                report.fail(engine, "walks less than A*", source, target);
+            }
+
+            return complete;
+        };
+
+        engines.jump_points.find_path(source, target, grid, reference);
+        bool optimal = check_engine("JPS+", reference);
+
+        double shortest = length(reference);
+        if (optimal) {
+            double exact = length(reference, std::sqrt(2.0));
+            if (
+                exact < query.optimal - EPSILON
+                || exact > query.optimal * (1 + EPSILON)
+            ) {
+                report.fail("JPS+", "path is not optimal", source, target);
+            }
+        }
+
+        path_t unbounded;
+        rectangle_expansion_astar<CompletePolicy>(
+            source,
+            target,
+            grid,
+            unbounded
+        );
+
+        bool exhaustive = check_engine("REA* (complete)", unbounded);
+
+        rectangle_expansion_astar<GreedyPolicy>(source, target, grid, other);
+        check_engine("REA* (greedy)", other);
+
+        rectangle_expansion_astar(source, target, indexed, other);
+        rectangle_expansion_astar(source, target, grid, path);
+        bool complete = check_engine("REA*", path);
+
+        if (other != path) {
+            report.fail("REA*", "path changes with clearance", source, target);
+        }
+
+        // Searches sliced into single expansions, by count or by a budget
+        // that runs out at once, resume where they stopped.
+        REAStarSolver& solver = engines.solver;
+        solver.begin(source, target, grid);
+
+        SearchStatus status = SearchStatus::IN_PROGRESS;
+        for (int i = 0; status == SearchStatus::IN_PROGRESS; i++) {
+            status = i % 2 == 0
+                ? solver.step(1)
+                : solver.step_for(std::chrono::microseconds(0));
+        }
+
+        other.clear();
+        solver.path(other);
+
+        if (other != path || (status == SearchStatus::FOUND) != complete) {
+            report.fail(
+                "REA* (stepped)",
+                "path differs from find_path",
+                source,
+                target
+            );
+        }
+
+        // Policies which only differ in how they treat partial and long
+        // paths find the same complete paths.
+        if (complete && exhaustive && unbounded != path) {
+            report.fail(
+                "REA* (complete)",
+                "path differs from the default policy",
+                source,
+                target
+            );
+        }
+
+        other.clear();
+        engines.hierarchy.find_path(source, target, grid, other);
+        check_engine("HPA*", other);
+
+        // Any point along a cached path leads to the rest of it.
+        if (complete) {
+            engines.cache.insert(path.begin(), path.end(), grid);
+
+            for (const Point& p : path) {
+                other.clear();
+                if (engines.cache.find_path(p, target, grid, other) == 0) {
+                    report.fail("cache", "misses path", p, target);
+                    continue;
+                }
+
+                check(report, map, "cached", other, p, target, true);
+            }
+        }
+
+        DistanceField& field = engines.field;
+
+        other.clear();
+        if (field.find_path(source, target, grid, other, FIELD_RADIUS) == 0) {
+            if (optimal && shortest <= FIELD_RADIUS - EPSILON) {
+                report.fail("field", "misses source in radius", source, target);
+            }
+
+            return;
+        }
+
+        if (!check(report, map, "field", other, source, target, true)) return;
+
+        if (
+            (optimal && std::abs(length(other) - shortest) > EPSILON)
+            || std::abs(field.distance(source) - length(other)) > EPSILON
+        ) {
+            report.fail("field", "path is not optimal", source, target);
+        }
+    }
+};
+
+int bench::verify(
+    const Map& map,
+    const std::vector<Query>& queries,
+    unsigned seed
+) {
+    Report report { .map = map };
+    if (queries.empty()) return 0;
+
+    Grid<bool> grid(map.width, map.height, map.cells);
+    Grid<bool> indexed(map.width, map.height, map.cells);
+    indexed.build_clearance();
+
+    Engines engines;
+    for (const Query& query : queries) {
+        check_query(report, map, query, grid, indexed, engines);
+    }
+
+    // Characters searching stand on tiles blocked for everyone else, like
+    // events following the player.
+    Map occupied = map;
+    Grid<bool> occupied_grid(map.width, map.height, map.cells);
+    Engines occupied_engines;
+
+    path_t path, other;
+    for (const Query& query : queries) {
+        const Point& source = query.source;
+        const Point& target = query.target;
+        if (source == target || query.optimal < 0) continue;
+
+        occupied.cells[source.x + source.y * map.width] = false;
+        occupied_grid.set(source, false);
+
+        check_occupied(
+            report,
+            occupied,
+            query,
+            occupied_grid,
+            occupied_engines
+        );
+
+        occupied.cells[source.x + source.y * map.width] = true;
+        occupied_grid.set(source, true);
+
+        // Paths to a character still end on it, so they are walked on the
+        // map where its tile is free.
+        occupied_grid.set(target, false);
+
+        path.clear();
+        occupied_engines.hierarchy.find_path(
+            source,
+            target,
+            occupied_grid,
+            path
+        );
+
+        check(report, map, "HPA*", path, source, target, true);
+        occupied_grid.set(target, true);
+    }
+
+    check_nearest(report, map, queries, grid);
+    check_weighted(report, map, queries, seed);
+
+    // Looping maps are searched across their edges, along one axis or both.
+    for (Topology topology : {
+        Topology { .loop_x = true, .loop_y = true },
+        Topology { .loop_x = true, .loop_y = false }
+    }) {
+        Map window = tile(map, topology, 2);
+        Map tiled = tile(map, topology, 3);
+        Grid<bool> looping(
+            map.width,
+            map.height,
+            map.cells,
+            nullptr,
+            nullptr,
+            topology
+        );
+
+        Engines looping_engines;
+        for (const Query& query : queries) {
+            check_looping(
+                report,
+                map,
+                window,
+                tiled,
+                query,
+                looping,
+                looping_engines
+            );
+        }
+    }
+
+    // Updates cells one at a time, or whole regions at once through
+    // invalidations, and compares every grid against a fresh one.
+    Map current = map;
+    auto fetch = [&current](const Point& p) {
+        return current.free(p.x, p.y);
+    };
+
+    Grid<bool> live(map.width, map.height, map.cells, fetch);
+    Grid<bool> live_indexed(map.width, map.height, map.cells, fetch);
+    live_indexed.build_clearance();
+
+    JumpPointSolver incremental;
+    Hierarchy hierarchy;
+    DistanceField field;
+    PathCache cache;
+    std::mt19937 rng(seed);
+
+    // Fields are only rebuilt when cells around their target change, so
+    // one is kept on the same target across updates.
+    const Point& root = queries.front().target;
+
+    for (int i = 0; i < UPDATES; i++) {
+        auto coordinate = [&](int size) {
+            return std::uniform_int_distribution<int>(0, size - 1)(rng);
+        };
+
+        if (i % 4 == 3) {
+            int left = coordinate(map.width),
+                top = coordinate(map.height),
+                right = std::min(left + coordinate(8), map.width - 1),
+                bottom = std::min(top + coordinate(8), map.height - 1);
+
+            for (int y = top; y <= bottom; y++) {
+                for (int x = left; x <= right; x++) {
+                    current.cells[x + y * map.width] = coordinate(3) != 0;
+                }
+            }
+
+            live.invalidate(left, top, right, bottom);
+            live_indexed.invalidate(left, top, right, bottom);
+        } else {
+            Point p = {
+                .x = coordinate(map.width),
+                .y = coordinate(map.height)
+            };
+
+            bool value = coordinate(3) != 0;
+
+            current.cells[p.x + p.y * map.width] = value;
+            live.set(p, value);
+            live_indexed.set(p, value);
+
+            // Setting a cell again changes nothing.
+            uint32_t version = live.version();
+            live.set(p, value);
+            if (live.version() != version) {
+                report.fail("grid", "version changes without a change", p, p);
+            }
+        }
+
+        // Paths cached before the updates are kept unless they cross them,
+        // and must still be walkable.
+        const Point& cached_source = queries.front().source;
+        if (
+            current.free(cached_source.x, cached_source.y)
+            && current.free(root.x, root.y)
+        ) {
+            other.clear();
+            if (cache.find_path(cached_source, root, live, other) > 0) {
+                check(
+                    report,
+                    current,
+                    "cached",
+                    other,
+                    cached_source,
+                    root,
+                    true
+                );
+            } else if (
+                rectangle_expansion_astar(cached_source, root, live, other) > 0
+                && other.back() == root
+            ) {
+                cache.insert(other.begin(), other.end(), live);
+            }
+        }
+
+        const Query& query = queries[i % queries.size()];
+        const Point& source = query.source;
+        const Point& target = query.target;
+
+        if (
+            !current.free(source.x, source.y)
+            || !current.free(target.x, target.y)
+        ) continue;
+
+        Grid<bool> fresh(map.width, map.height, current.cells);
+        bool reachable = optimal_length(current, source, target) >= 0;
+
+        rectangle_expansion_astar(source, target, fresh, path);
+        check(report, current, "REA*", path, source, target, reachable);
+
+        rectangle_expansion_astar(source, target, live, other);
+        if (other != path) {
+            report.fail("REA*", "path changes with updates", source, target);
+        }
+
+        rectangle_expansion_astar(source, target, live_indexed, other);
+        if (other != path) {
+            report.fail(
+                "REA*",
+                "path changes with updates to clearance",
+                source,
+                target
+            );
+        }
+
+        path.clear();
+        JumpPointSolver().find_path(source, target, fresh, path);
+        check(report, current, "JPS+", path, source, target, reachable);
+
+        other.clear();
+        incremental.find_path(source, target, live, other);
+        if (other != path) {
+            report.fail("JPS+", "path changes with updates", source, target);
+        }
+
+        other.clear();
+        hierarchy.find_path(source, target, live, other);
+        check(report, current, "HPA*", other, source, target, reachable);
+
+        if (!current.free(root.x, root.y)) continue;
+
+        double optimal = optimal_length(current, source, root);
+
+        other.clear();
+        if (field.find_path(source, root, live, other, FIELD_RADIUS) == 0) {
+            if (optimal >= 0 && optimal <= FIELD_RADIUS - EPSILON) {
+                report.fail(
+                    "field",
+                    "misses source in radius after updates",
+                    source,
+                    root
+                );
+            }
+        } else if (check(report, current, "field", other, source, root, true)) {
+            double exact = length(other, std::sqrt(2.0));
+            if (exact < optimal - EPSILON || exact > optimal * (1 + EPSILON)) {
+                report.fail(
+                    "field",
+                    "path is not optimal after updates",
+                    source,
+                    root
+                );
+            }
+        }
+    }
+
+    return report.failures;
+}
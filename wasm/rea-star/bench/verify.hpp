@@ -0,0 +1,62 @@
+/**
+ * @file verify.hpp
+ * 
+ * @author Brandt
+ * @date 2020/10/18
+ * @license Zlib
+ * 
+ * Correctness checks for the module's searches on benchmark maps.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "map.hpp"
+
+namespace rea_star::bench {
+    /**
+     * Runs every search engine on a set of queries and checks their paths.
+     * 
+     * Each path must start on its source and end on its target whenever the
+     * target can be reached. Each of its segments must also be walkable cell
+     * by cell, moving towards the next point one free tile at a time. On top
+     * of that:
+     * 
+     * - no path may take fewer orthogonal steps to walk than the plain A*
+     *   one, and JPS+ paths must be optimal;
+     * - REA* must find the same paths with and without a clearance index,
+     *   and with the default and complete policies, and the same path
+     *   when its search is stepped one expansion at a time;
+     * - REA* searches for the nearest of several targets must end on one,
+     *   no further than the shortest REA* path to any of them;
+     * - lookups from any point of a cached path must hit it;
+     * - distance field paths must cover every source within their radius,
+     *   with the same length as JPS+ paths;
+     * - HPA* and distance fields must find paths from sources on blocked
+     *   tiles, and HPA* paths to blocked targets too;
+     * - after random cell updates and invalidations, grids must give the
+     *   same paths as a grid built from scratch, and JPS+ the same paths as
+     *   a fresh solver. Setting a cell to its own value must keep the grid's
+     *   version, and paths cached across updates must stay walkable;
+     * - on the map made to loop, plain A* and REA* paths must be walkable
+     *   across its edges, plain A* ones optimal within the copies held by
+     *   the grid, while JPS+, HPA* and distance fields find no path;
+     * - on the map with random patches of costs, weighted REA* paths may
+     *   cost more than the cheapest ones found by Dijkstra's algorithm, but
+     *   never less.
+     * 
+     * Failures are printed as they are found.
+     * 
+     * @param map benchmark map.
+     * @param queries path queries on the map.
+     * @param seed random seed for the updates.
+     * 
+     * @return the number of failed checks.
+     */
+    int verify(
+        const Map& map,
+        const std::vector<Query>& queries,
+        unsigned seed
+    );
+};
@@ -0,0 +1,213 @@
+#include "distance_field.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "../data/rect.hpp"
+
+using namespace rea_star;
+
+namespace {
+    constexpr int DX[] = { 0, 1, 1, 1, 0, -1, -1, -1 };
+    constexpr int DY[] = { -1, -1, 0, 1, 1, 1, 0, -1 };
+};
+
+size_t DistanceField::find_path(
+    const Point& source,
+    const Point& target,
+    Grid<bool>& g,
+    path_t& out,
+    int radius
+) {
+    // Fields don't spread across the edges of the map, and the second copy
+    // of a looping map is no place to send anyone.
+    if (g.loops()) return 0;
+
+    if (
+        target != m_target
+        || radius != m_radius
+        || &g != m_grid
+        || stale(g)
+    ) build(target, g, radius);
+
+    Point first = source;
+    if (distance(source) != INFINITY) {
+        first = next(source);
+    } else if (!g.enterable(source)) {
+        // Blocked sources step onto the field first.
+        first = entry(source, g);
+    }
+
+    if (first == source && source != target) return 0;
+
+    size_t start = out.size();
+    out.push_back(source);
+
+    // Consecutive steps in the same direction are merged into one segment.
+    int dx = 0, dy = 0;
+    for (Point p = source; p != target;) {
+        Point q = p == source ? first : next(p);
+
+        int sx = q.x - p.x,
+            sy = q.y - p.y;
+
+        bool unit = std::abs(sx) <= 1 && std::abs(sy) <= 1;
+        if (unit && sx == dx && sy == dy && out.size() - start > 1) {
+            out.back() = q;
+        } else {
+            out.push_back(q);
+        }
+
+        dx = unit ? sx : 0;
+        dy = unit ? sy : 0;
+        p = q;
+    }
+
+    return out.size() - start;
+}
+
+void DistanceField::build(const Point& target, Grid<bool>& g, int radius) {
+    m_width = g.width();
+    m_radius = radius;
+    m_target = target;
+    m_grid = &g;
+    m_version = g.version();
+
+    m_nodes.reset(g.width(), g.height(), Node {
+        .distance = INFINITY,
+        .link = index(target)
+    });
+
+    m_open.reset(size_t(g.width()) * g.height());
+
+    if (!g.enterable(target)) return;
+
+    // Cells on the free rectangle around the target are reached in a
+    // straight line, so only its edges need to be searched from.
+    Rect rect = Rect::expand_point(target, g);
+
+    int left = std::max(rect.left(), target.x - radius),
+        top = std::max(rect.top(), target.y - radius),
+        right = std::min(rect.right(), target.x + radius),
+        bottom = std::min(rect.bottom(), target.y + radius);
+
+    for (int y = top; y <= bottom; y++) {
+        for (int x = left; x <= right; x++) {
+            Point p = { .x = x, .y = y };
+
+            float distance = octile(p, target);
+            if (distance > radius) continue;
+
+            m_nodes[p].distance = distance;
+
+            bool edge = x == left || x == right || y == top || y == bottom;
+            if (edge) m_open.push(index(p), distance);
+        }
+    }
+
+    auto free = [&](int x, int y) {
+        return x >= 0 && y >= 0 && x < g.width() && y < g.height()
+            && g.enterable({ .x = x, .y = y });
+    };
+
+    auto open = [&](const Point& from, const Point& to) {
+        return free(to.x, to.y) && g.passable(from, to);
+    };
+
+    while (!m_open.empty()) {
+        uint32_t cell = m_open.pop();
+        Point p = point(cell);
+        float distance = m_nodes[p].distance;
+
+        for (int d = 0; d < 8; d++) {
+            int x = p.x + DX[d],
+                y = p.y + DY[d];
+
+            Point q = { .x = x, .y = y };
+
+            // Diagonal moves can't cut corners, so both orthogonal routes
+            // to them must be open.
+            if (DX[d] != 0 && DY[d] != 0) {
+                Point a = { .x = p.x + DX[d], .y = p.y },
+                      b = { .x = p.x, .y = p.y + DY[d] };
+
+                if (!open(p, a) || !open(a, q) || !open(p, b) || !open(b, q)) {
+                    continue;
+                }
+            } else if (!open(p, q)) {
+                continue;
+            }
+
+            float qdistance = distance + float(octile(p, q));
+            if (qdistance > radius) continue;
+
+            Node& node = m_nodes[q];
+            if (qdistance >= node.distance) continue;
+
+            node.distance = qdistance;
+            node.link = cell;
+
+            m_open.push(index(q), qdistance);
+        }
+    }
+}
+
+bool DistanceField::stale(const Grid<bool>& g) {
+    if (g.version() == m_version) return false;
+
+    int left = m_target.x - m_radius,
+        top = m_target.y - m_radius,
+        right = m_target.x + m_radius,
+        bottom = m_target.y + m_radius;
+
+    // Cells further than the radius along either axis are too far to be on
+    // the field, or to change any path along it.
+    bool changed = false;
+    auto check = [&](const Grid<bool>::Change& change) {
+        changed = changed || change.overlaps(left, top, right, bottom);
+    };
+
+    bool known = g.for_each_change(m_version, check);
+
+    if (!known || changed) return true;
+
+    m_version = g.version();
+    return false;
+}
+
+Point DistanceField::entry(const Point& source, Grid<bool>& g) const {
+    auto open = [&](const Point& from, const Point& to) {
+        return to.x >= 0 && to.y >= 0 && to.x < g.width() && to.y < g.height()
+            && g.enterable(to) && g.passable(from, to);
+    };
+
+    Point best = source;
+    float best_distance = INFINITY;
+
+    // Moves off the source follow the same rules as moves along the field.
+    for (int d = 0; d < 8; d++) {
+        Point q = { .x = source.x + DX[d], .y = source.y + DY[d] };
+
+        if (DX[d] != 0 && DY[d] != 0) {
+            Point a = { .x = q.x, .y = source.y },
+                  b = { .x = source.x, .y = q.y };
+
+            if (
+                !open(source, a)
+                || !open(a, q)
+                || !open(source, b)
+                || !open(b, q)
+            ) continue;
+        } else if (!open(source, q)) {
+            continue;
+        }
+
+        float qdistance = distance(q) + float(octile(source, q));
+        if (qdistance < best_distance) {
+            best = q;
+            best_distance = qdistance;
+        }
+    }
+
+    return best;
+}
@@ -0,0 +1,139 @@
+/**
+ * @file distance_field.hpp
+ * 
+ * @author Brandt
+ * @date 2020/10/16
+ * @license Zlib
+ * 
+ * Distance field rooted at a single target.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#include "rea_star.hpp"
+
+#include "../data/grid.hpp"
+#include "../data/indexed_heap.hpp"
+#include "../data/stamped_grid.hpp"
+
+namespace rea_star {
+    /**
+     * Distances from every cell around a target to the target, along with
+     * the next point on the way there, for many searches with the same
+     * target.
+     * 
+     * The field is built backwards from the target. Every cell on the free
+     * rectangle REA* expands around the target is filled at once, since its
+     * distance is the octile distance to the target. Dijkstra's algorithm
+     * takes over from the edges of that rectangle, on 8 directions without
+     * cutting corners, up to a given radius.
+     * 
+     * The field is rebuilt only when it is used with another target, radius
+     * or grid, or cells within its radius change. Any number of searches
+     * from different sources then cost a walk along the field each.
+     * 
+     * Sources on blocked cells, like the tiles taken by the characters
+     * searching, are not on the field, but step onto their closest neighbor
+     * on it.
+     */
+    class DistanceField {
+        public:
+            DistanceField() = default;
+
+            /**
+             * Finds the path from a point to the target of the field,
+             * rebuilding it first if needed.
+             * 
+             * @param source starting point.
+             * @param target goal point.
+             * @param g boolean matrix.
+             * @param out receives the path, after its current contents.
+             * @param radius maximum distance from the target covered by the
+             *        field.
+             * 
+             * @return the number of points appended, zero if neither the
+             *         source nor, for a blocked source, any of its neighbors
+             *         is covered by the field, or if the matrix loops.
+             */
+            size_t find_path(
+                const Point& source,
+                const Point& target,
+                Grid<bool>& g,
+                path_t& out,
+                int radius
+            );
+
+            /**
+             * Builds the field for a target.
+             * 
+             * @param target goal point.
+             * @param g boolean matrix.
+             * @param radius maximum distance from the target covered by the
+             *        field.
+             */
+            void build(const Point& target, Grid<bool>& g, int radius);
+
+            /**
+             * @param p point on the grid of the field.
+             * 
+             * @return the length of the shortest path from the point to the
+             *         target, or infinity if the field doesn't cover it.
+             */
+            float distance(const Point& p) const {
+                return m_nodes[p].distance;
+            }
+
+            /**
+             * @param p point covered by the field, other than the target.
+             * 
+             * @return the next point on the shortest path from the point to
+             *         the target. Points on the free rectangle around the
+             *         target lead straight to it.
+             */
+            Point next(const Point& p) const {
+                return point(m_nodes[p].link);
+            }
+
+        private:
+            struct Node {
+                float distance;
+                uint32_t link;
+            };
+
+            int m_width = 0;
+            int m_radius = -1;
+            Point m_target = { .x = -1, .y = -1 };
+            const Grid<bool>* m_grid = nullptr;
+            uint32_t m_version = 0;
+
+            StampedGrid<Node> m_nodes;
+            IndexedHeap<float> m_open;
+
+            /**
+             * Checks whether any cell within the radius of the field changed
+             * since it was built. Otherwise, the field is moved on to the
+             * current version of the grid.
+             */
+            bool stale(const Grid<bool>& g);
+
+            /**
+             * @return the neighbor of a blocked source with the shortest path
+             *         to the target through it, or the source itself if the
+             *         field covers none that it can move to.
+             */
+            Point entry(const Point& source, Grid<bool>& g) const;
+
+            uint32_t index(const Point& p) const {
+                return p.y * m_width + p.x;
+            }
+
+            Point point(uint32_t index) const {
+                return Point {
+                    .x = int(index % m_width),
+                    .y = int(index / m_width)
+                };
+            }
+    };
+};
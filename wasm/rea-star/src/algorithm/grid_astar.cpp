@@ -0,0 +1,150 @@
+#include "grid_astar.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+
+using namespace rea_star;
+
+namespace rea_star {
+    /**
+     * @return the solver shared by grid A* searches on the current thread.
+     */
+    GridAStarSolver& grid_astar_solver() {
+        thread_local GridAStarSolver solver;
+        return solver;
+    }
+
+    int manhattan(const Point& a, const Point& b) {
+        return std::abs(a.x - b.x) + std::abs(a.y - b.y);
+    }
+
+    uint64_t priority(int32_t gvalue, int32_t hvalue) {
+        return uint64_t(gvalue + hvalue) << 32 | uint32_t(hvalue);
+    }
+};
+
+size_t GridAStarSolver::find_path(
+    const Point& source,
+    const Point& target,
+    Grid<bool>& g,
+    path_t& out,
+    int maxlen,
+    SearchStats* stats
+) {
+    static constexpr Point STEPS[] = {
+        { .x = 0, .y = -1 },
+        { .x = 1, .y = 0 },
+        { .x = 0, .y = 1 },
+        { .x = -1, .y = 0 }
+    };
+
+    m_width = g.width();
+
+    // Searches on looping grids run on a window around the source, towards
+    // every copy of the target, as with REA*.
+    m_targets.clear();
+    if (g.loops()) {
+        g.for_each_image(target, [&](const Point& p) {
+            m_targets.push_back(p);
+        });
+    } else {
+        m_targets.push_back(target);
+    }
+
+    Point start = g.loops() ? g.unwrap(source) : source;
+
+    auto hvalue = [&](const Point& p) {
+        int h = INT32_MAX;
+        for (const Point& t : m_targets) h = std::min(h, manhattan(p, t));
+
+        return h;
+    };
+
+    m_nodes.reset(g.width(), g.height(), Node {
+        .gvalue = INT32_MAX,
+        .link = index(start)
+    });
+
+    m_nodes[start].gvalue = 0;
+
+    m_open.reset(size_t(g.width()) * g.height());
+    m_open.push(index(start), priority(0, hvalue(start)));
+
+    Point best = start;
+    int best_hvalue = hvalue(start);
+
+    while (!m_open.empty()) {
+        Point p = point(m_open.pop());
+
+        // Copies of the target are the only cells without a heuristic, so
+        // the first one found stays the best point.
+        if (best_hvalue == 0 && p == best) break;
+
+        if (stats) stats->expansions++;
+
+        int32_t gvalue = m_nodes[p].gvalue + 1;
+        if (gvalue >= maxlen) continue;
+
+        for (const Point& step : STEPS) {
+            Point q = { .x = p.x + step.x, .y = p.y + step.y };
+            if (q.x < 0 || q.y < 0 || q.x >= g.width() || q.y >= g.height()) {
+                continue;
+            }
+
+            Node& node = m_nodes[q];
+            if (gvalue >= node.gvalue || !g.enterable(q)) continue;
+            if (!g.passable(p, q)) continue;
+
+            node.gvalue = gvalue;
+            node.link = index(p);
+
+            int qhvalue = hvalue(q);
+            if (qhvalue < best_hvalue) {
+                best = q;
+                best_hvalue = qhvalue;
+            }
+
+            m_open.push(index(q), priority(gvalue, qhvalue));
+        }
+    }
+
+    size_t offset = out.size();
+
+    for (Point current = best; current != start;) {
+        out.push_back(current);
+        current = point(m_nodes[current].link);
+    }
+
+    out.push_back(start);
+
+    std::reverse(out.begin() + offset, out.end());
+
+    // Steps are a single cell long, so every point can be mapped back on
+    // its own.
+    if (g.loops()) {
+        for (auto it = out.begin() + offset; it != out.end(); ++it) {
+            *it = g.wrap(*it);
+        }
+    }
+
+    return out.size() - offset;
+}
+
+size_t rea_star::grid_astar(
+    Point source,
+    Point target,
+    Grid<bool>& g,
+    path_t& out,
+    int maxlen,
+    SearchStats* stats
+) {
+    out.clear();
+    return grid_astar_solver().find_path(
+        source,
+        target,
+        g,
+        out,
+        maxlen,
+        stats
+    );
+}
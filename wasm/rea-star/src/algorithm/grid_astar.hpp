@@ -0,0 +1,116 @@
+/**
+ * @file grid_astar.hpp
+ * 
+ * @author Brandt
+ * @date 2020/10/15
+ * @license Zlib
+ * 
+ * Plain A* on 4-connected boolean grids.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "rea_star.hpp"
+
+#include "../data/grid.hpp"
+#include "../data/indexed_heap.hpp"
+#include "../data/stamped_grid.hpp"
+
+namespace rea_star {
+    /**
+     * Reusable A* search context for 4-connected boolean grids, where every
+     * step costs 1.
+     * 
+     * Scores are stored in a grid and the open list is an indexed heap, so
+     * that improving a cell updates its entry in place. Both are reset in
+     * constant time between searches.
+     */
+    class GridAStarSolver {
+        public:
+            GridAStarSolver() = default;
+
+            /**
+             * Finds the shortest 4-connected path between two points on a
+             * boolean matrix, with one point per step.
+             * 
+             * @param source starting point.
+             * @param target goal point.
+             * @param g boolean matrix.
+             * @param out receives the path, after its current contents. If
+             *        the target can't be reached, it receives the path to the
+             *        closest point found instead. Paths on looping grids
+             *        may cross the edges of the map, and are given in map
+             *        coordinates.
+             * @param maxlen maximum length of the path.
+             * @param stats if not null, receives counters for the search.
+             * 
+             * @return the number of points appended.
+             */
+            size_t find_path(
+                const Point& source,
+                const Point& target,
+                Grid<bool>& g,
+                path_t& out,
+                int maxlen = DEFAULT_PATH_MAXLEN,
+                SearchStats* stats = nullptr
+            );
+
+        private:
+            struct Node {
+                int32_t gvalue;
+                uint32_t link;
+            };
+
+            int m_width = 0;
+
+            StampedGrid<Node> m_nodes;
+
+            /**
+             * Every copy of the target on the grid.
+             */
+            std::vector<Point> m_targets;
+
+            /**
+             * Open cells, by f-value and then by h-value, so that ties are
+             * broken towards the target.
+             */
+            IndexedHeap<uint64_t> m_open;
+
+            uint32_t index(const Point& p) const {
+                return p.y * m_width + p.x;
+            }
+
+            Point point(uint32_t index) const {
+                return Point {
+                    .x = int(index % m_width),
+                    .y = int(index / m_width)
+                };
+            }
+    };
+
+    /**
+     * Applies A* to find the shortest 4-connected path between two points on
+     * a boolean matrix, with a solver shared by searches on the current
+     * thread.
+     * 
+     * @param source starting point.
+     * @param target goal point.
+     * @param g boolean matrix.
+     * @param out receives the path, replacing its contents.
+     * @param maxlen maximum length of the path.
+     * @param stats if not null, receives counters for the search.
+     * 
+     * @return the number of points on the path.
+     */
+    size_t grid_astar(
+        Point source,
+        Point target,
+        Grid<bool>& g,
+        path_t& out,
+        int maxlen = DEFAULT_PATH_MAXLEN,
+        SearchStats* stats = nullptr
+    );
+};
@@ -0,0 +1,467 @@
+#include "hierarchy.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+using namespace rea_star;
+
+size_t Hierarchy::find_path(
+    const Point& source,
+    const Point& target,
+    Grid<bool>& g,
+    path_t& out
+) {
+    m_waypoints.clear();
+    if (find_waypoints(source, target, g, m_waypoints) == 0) return 0;
+
+    size_t start = out.size();
+    out.push_back(m_waypoints.front());
+
+    for (size_t i = 1; i < m_waypoints.size(); i++) {
+        if (refine_segment(m_waypoints[i - 1], m_waypoints[i], g, out) == 0) {
+            out.resize(start);
+            return 0;
+        }
+    }
+
+    return out.size() - start;
+}
+
+size_t Hierarchy::find_waypoints(
+    const Point& source,
+    const Point& target,
+    Grid<bool>& g,
+    path_t& out
+) {
+    // Clusters don't link across the edges of the map, and the second copy
+    // of a looping map is no place to send anyone.
+    if (g.loops()) return 0;
+
+    sync(g);
+
+    if (source == target) {
+        out.push_back(source);
+        return 1;
+    }
+
+    // Blocked sources and targets, like characters searching for each
+    // other, are left and entered through their free neighbors instead.
+    // Those may be on other clusters, past edges the blocked cell hides
+    // from the entrances.
+    add_ports(source, g, m_starts);
+    add_ports(target, g, m_ends);
+
+    m_start_costs.clear();
+    for (Port& start : m_starts) {
+        const Cluster& c = m_clusters[start.cluster];
+        load_local(c, g);
+
+        start.costs = m_start_costs.size();
+        for (const Entrance& entrance : c.entrances) {
+            m_start_costs.push_back(local_cost(c, start.cell, entrance.cell));
+        }
+
+        for (const Port& end : m_ends) {
+            m_start_costs.push_back(
+                end.cluster == start.cluster
+                    ? local_cost(c, start.cell, end.cell)
+                    : INFINITY
+            );
+        }
+    }
+
+    m_end_costs.clear();
+    for (Port& end : m_ends) {
+        const Cluster& c = m_clusters[end.cluster];
+        load_local(c, g);
+
+        end.costs = m_end_costs.size();
+        for (const Entrance& entrance : c.entrances) {
+            m_end_costs.push_back(local_cost(c, entrance.cell, end.cell));
+        }
+    }
+
+    m_nodes.reset(m_width, m_height, Node {
+        .gvalue = INFINITY,
+        .link = index(source)
+    });
+
+    m_nodes[source].gvalue = 0;
+
+    m_open.clear();
+    for (const Port& start : m_starts) {
+        m_nodes[start.cell].gvalue = start.cost;
+        m_open.push_back(SearchNode {
+            .fvalue = start.cost + float(octile(start.cell, target)),
+            .cell = index(start.cell)
+        });
+    }
+
+    std::make_heap(m_open.begin(), m_open.end(), std::greater<SearchNode>());
+
+    while (!m_open.empty()) {
+        std::pop_heap(m_open.begin(), m_open.end(), std::greater<SearchNode>());
+        SearchNode next = m_open.back();
+        m_open.pop_back();
+
+        Point p = point(next.cell);
+        float gvalue = m_nodes[p].gvalue;
+        if (next.fvalue > gvalue + octile(p, target) + 1e-3f) continue;
+
+        if (p == target) {
+            size_t start = out.size();
+
+            for (Point current = target; current != source;) {
+                out.push_back(current);
+                current = point(m_nodes[current].link);
+            }
+
+            out.push_back(source);
+
+            std::reverse(out.begin() + start, out.end());
+            return out.size() - start;
+        }
+
+        auto relax = [&](const Point& q, float cost) {
+            float qgvalue = gvalue + cost;
+
+            Node& node = m_nodes[q];
+            if (qgvalue >= node.gvalue) return;
+
+            node.gvalue = qgvalue;
+            node.link = next.cell;
+
+            m_open.push_back(SearchNode {
+                .fvalue = qgvalue + float(octile(q, target)),
+                .cell = index(q)
+            });
+
+            std::push_heap(
+                m_open.begin(),
+                m_open.end(),
+                std::greater<SearchNode>()
+            );
+        };
+
+        for (const Port& start : m_starts) {
+            if (start.cell != p) continue;
+
+            const Cluster& c = m_clusters[start.cluster];
+            const float* costs = m_start_costs.data() + start.costs;
+
+            size_t n = c.entrances.size();
+            for (size_t i = 0; i < n; i++) relax(c.entrances[i].cell, costs[i]);
+
+            for (size_t i = 0; i < m_ends.size(); i++) {
+                relax(m_ends[i].cell, costs[n + i]);
+            }
+        }
+
+        for (const Port& end : m_ends) {
+            if (end.cell == p) relax(target, end.cost);
+        }
+
+        int ci = cluster_index(p);
+        Cluster& c = m_clusters[ci];
+        int e = entrance_index(c, p);
+        if (e < 0) continue;
+
+        const Entrance& entrance = c.entrances[e];
+        for (int i = 0; i < entrance.partner_count; i++) {
+            relax(entrance.partners[i], 1);
+        }
+
+        size_t n = c.entrances.size();
+        for (size_t i = 0; i < n; i++) {
+            if (int(i) != e) relax(c.entrances[i].cell, c.costs[e * n + i]);
+        }
+
+        for (const Port& end : m_ends) {
+            if (end.cluster == ci) relax(end.cell, m_end_costs[end.costs + e]);
+        }
+    }
+
+    return 0;
+}
+
+size_t Hierarchy::refine(
+    const Point& from,
+    const Point& to,
+    Grid<bool>& g,
+    path_t& out
+) {
+    sync(g);
+    return refine_segment(from, to, g, out);
+}
+
+size_t Hierarchy::refine_segment(
+    const Point& from,
+    const Point& to,
+    Grid<bool>& g,
+    path_t& out
+) {
+    if (from == to) return 0;
+
+    const Cluster& cluster = m_clusters[cluster_index(from)];
+    if (&cluster != &m_clusters[cluster_index(to)]) {
+        out.push_back(to);
+        return 1;
+    }
+
+    // Waypoints other than the source and target are free, so only those
+    // two may need to be opened.
+    load_local(cluster, g);
+    open_local(cluster, from);
+    open_local(cluster, to);
+
+    Point offset = { .x = cluster.left, .y = cluster.top };
+    Point local_from = { .x = from.x - offset.x, .y = from.y - offset.y };
+    Point local_to = { .x = to.x - offset.x, .y = to.y - offset.y };
+
+    m_buffer.clear();
+    m_solver.find_path(local_from, local_to, m_local, m_buffer);
+    if (m_buffer.empty() || m_buffer.back() != local_to) return 0;
+
+    for (size_t i = 1; i < m_buffer.size(); i++) {
+        out.push_back(Point {
+            .x = m_buffer[i].x + offset.x,
+            .y = m_buffer[i].y + offset.y
+        });
+    }
+
+    return m_buffer.size() - 1;
+}
+
+void Hierarchy::sync(Grid<bool>& g) {
+    int words = bits::words(g.width());
+    bool resized = g.width() != m_width || g.height() != m_height;
+
+    if (resized) {
+        m_width = g.width();
+        m_height = g.height();
+        m_columns = (m_width + m_cluster_size - 1) / m_cluster_size;
+
+        int rows = (m_height + m_cluster_size - 1) / m_cluster_size;
+
+        m_clusters.clear();
+        for (int y = 0; y < rows; y++) {
+            for (int x = 0; x < m_columns; x++) {
+                int left = x * m_cluster_size,
+                    top = y * m_cluster_size;
+
+                m_clusters.push_back(Cluster {
+                    .left = left,
+                    .top = top,
+                    .width = std::min(m_cluster_size, m_width - left),
+                    .height = std::min(m_cluster_size, m_height - top),
+                    .entrances = {},
+                    .costs = {},
+                    .dirty = true
+                });
+            }
+        }
+
+        m_snapshot.assign(words * m_height, 0);
+    }
+
+    auto mark = [&](int x, int y) {
+        Cluster& cluster = m_clusters[cluster_index({ .x = x, .y = y })];
+        cluster.dirty = true;
+
+        if (x == cluster.left && x > 0) {
+            m_clusters[cluster_index({ .x = x - 1, .y = y })].dirty = true;
+        }
+
+        if (x == cluster.left + cluster.width - 1 && x + 1 < m_width) {
+            m_clusters[cluster_index({ .x = x + 1, .y = y })].dirty = true;
+        }
+
+        if (y == cluster.top && y > 0) {
+            m_clusters[cluster_index({ .x = x, .y = y - 1 })].dirty = true;
+        }
+
+        if (y == cluster.top + cluster.height - 1 && y + 1 < m_height) {
+            m_clusters[cluster_index({ .x = x, .y = y + 1 })].dirty = true;
+        }
+    };
+
+    for (int y = 0; y < m_height; y++) {
+        const bits::word_t* row = g.row(y);
+        bits::word_t* snapshot = m_snapshot.data() + y * words;
+
+        for (int w = 0; w < words; w++) {
+            bits::word_t diff = row[w] ^ snapshot[w];
+            if (diff == 0) continue;
+
+            snapshot[w] = row[w];
+            if (resized) continue;
+
+            for (; diff != 0; diff &= diff - 1) {
+                mark(w * bits::WORD_BITS + __builtin_ctzll(diff), y);
+            }
+        }
+    }
+
+    for (Cluster& cluster : m_clusters) {
+        if (cluster.dirty) rebuild(cluster, g);
+    }
+}
+
+void Hierarchy::rebuild(Cluster& cluster, Grid<bool>& g) {
+    cluster.entrances.clear();
+
+    for (Cardinal side : CARDINALS) add_entrances(cluster, g, side);
+
+    size_t n = cluster.entrances.size();
+    cluster.costs.assign(n * n, 0);
+
+    load_local(cluster, g);
+
+    for (size_t i = 0; i < n; i++) {
+        for (size_t j = i + 1; j < n; j++) {
+            float cost = local_cost(
+                cluster,
+                cluster.entrances[i].cell,
+                cluster.entrances[j].cell
+            );
+
+            cluster.costs[i * n + j] = cost;
+            cluster.costs[j * n + i] = cost;
+        }
+    }
+
+    cluster.dirty = false;
+}
+
+void Hierarchy::add_entrances(
+    Cluster& cluster,
+    Grid<bool>& g,
+    Cardinal side
+) {
+    bool vertical = axis(side) == Axis::X;
+
+    int fixed = 0;
+    switch (side) {
+    case Cardinal::NORTH: fixed = cluster.top; break;
+    case Cardinal::SOUTH: fixed = cluster.top + cluster.height - 1; break;
+    case Cardinal::WEST: fixed = cluster.left; break;
+    case Cardinal::EAST: fixed = cluster.left + cluster.width - 1; break;
+    }
+
+    int beyond = fixed + step(side);
+    if (beyond < 0 || beyond >= (vertical ? m_width : m_height)) return;
+
+    int min = vertical ? cluster.top : cluster.left,
+        max = min + (vertical ? cluster.height : cluster.width) - 1;
+
+    auto cell = [&](int fixed, int i) {
+        return vertical
+            ? Point { .x = fixed, .y = i }
+            : Point { .x = i, .y = fixed };
+    };
+
+    auto open = [&](int i) {
+        return g[cell(fixed, i)] && g[cell(beyond, i)];
+    };
+
+    for (int i = min; i <= max; i++) {
+        if (!open(i)) continue;
+
+        int start = i;
+        while (i + 1 <= max && open(i + 1)) i++;
+
+        if (i - start + 1 < MAX_ENTRANCE_WIDTH) {
+            int middle = (start + i) / 2;
+            add_entrance(cluster, cell(fixed, middle), cell(beyond, middle));
+        } else {
+            add_entrance(cluster, cell(fixed, start), cell(beyond, start));
+            add_entrance(cluster, cell(fixed, i), cell(beyond, i));
+        }
+    }
+}
+
+void Hierarchy::add_entrance(Cluster& cluster, Point cell, Point partner) {
+    int e = entrance_index(cluster, cell);
+    if (e >= 0) {
+        Entrance& entrance = cluster.entrances[e];
+        entrance.partners[entrance.partner_count++] = partner;
+        return;
+    }
+
+    cluster.entrances.push_back(Entrance {
+        .cell = cell,
+        .partners = { partner },
+        .partner_count = 1
+    });
+}
+
+void Hierarchy::load_local(const Cluster& cluster, Grid<bool>& g) {
+    std::vector<uint8_t> data(cluster.width * cluster.height);
+
+    for (int y = 0; y < cluster.height; y++) {
+        for (int x = 0; x < cluster.width; x++) {
+            data[x + y * cluster.width] = g[{
+                .x = cluster.left + x,
+                .y = cluster.top + y
+            }];
+        }
+    }
+
+    m_local = Grid<bool>(cluster.width, cluster.height, data);
+}
+
+void Hierarchy::open_local(const Cluster& cluster, const Point& p) {
+    m_local.set({ .x = p.x - cluster.left, .y = p.y - cluster.top }, true);
+}
+
+void Hierarchy::add_ports(
+    const Point& p,
+    Grid<bool>& g,
+    std::vector<Port>& out
+) {
+    out.clear();
+
+    if (g[p]) {
+        out.push_back(Port { .cell = p, .cluster = cluster_index(p) });
+        return;
+    }
+
+    for (Cardinal cardinal : CARDINALS) {
+        Point q = p;
+        (axis(cardinal) == Axis::X ? q.x : q.y) += step(cardinal);
+
+        if (q.x < 0 || q.y < 0 || q.x >= m_width || q.y >= m_height) continue;
+        if (!g[q]) continue;
+
+        out.push_back(Port {
+            .cell = q,
+            .cluster = cluster_index(q),
+            .cost = 1
+        });
+    }
+}
+
+float Hierarchy::local_cost(const Cluster& cluster, Point from, Point to) {
+    Point local_from = { .x = from.x - cluster.left, .y = from.y - cluster.top };
+    Point local_to = { .x = to.x - cluster.left, .y = to.y - cluster.top };
+
+    m_buffer.clear();
+    m_solver.find_path(local_from, local_to, m_local, m_buffer);
+    if (m_buffer.empty() || m_buffer.back() != local_to) return INFINITY;
+
+    float cost = 0;
+    for (size_t i = 1; i < m_buffer.size(); i++) {
+        cost += octile(m_buffer[i - 1], m_buffer[i]);
+    }
+
+    return cost;
+}
+
+int Hierarchy::entrance_index(const Cluster& cluster, const Point& p) const {
+    for (size_t i = 0; i < cluster.entrances.size(); i++) {
+        if (cluster.entrances[i].cell == p) return i;
+    }
+
+    return -1;
+}
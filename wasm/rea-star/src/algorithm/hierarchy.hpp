@@ -0,0 +1,249 @@
+/**
+ * @file hierarchy.hpp
+ * 
+ * @author Brandt
+ * @date 2020/10/14
+ * @license Zlib
+ * 
+ * Hierarchical path search (HPA*) built on top of REA*.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "rea_star.hpp"
+
+#include "../data/bits.hpp"
+#include "../data/grid.hpp"
+#include "../data/stamped_grid.hpp"
+
+namespace rea_star {
+    /**
+     * Default width and height of the clusters in a hierarchy.
+     */
+    constexpr int DEFAULT_CLUSTER_SIZE = 16;
+
+    /**
+     * Abstraction of a boolean matrix for hierarchical path search.
+     * 
+     * The matrix is split into square clusters. Cells where two neighboring
+     * clusters connect become entrances, which are linked to the other
+     * entrances on the same cluster with the length of the path between them
+     * found by REA* inside the cluster. Searches run on that small graph of
+     * entrances, and only the segments of the path they pick are refined
+     * into cell paths afterwards.
+     * 
+     * The hierarchy keeps a copy of the matrix it was built from, and
+     * rebuilds only the clusters that changed on the next search.
+     */
+    class Hierarchy {
+        public:
+            /**
+             * @param cluster_size width and height of each cluster.
+             */
+            explicit Hierarchy(int cluster_size = DEFAULT_CLUSTER_SIZE):
+                m_cluster_size(cluster_size) {};
+
+            /**
+             * Finds a path between two points on a boolean matrix by
+             * searching the abstract graph and refining every segment.
+             * 
+             * The source and target may be on blocked cells, like those
+             * taken by characters. A path to a blocked target still ends on
+             * it.
+             * 
+             * @param source starting point, inside the matrix.
+             * @param target goal point, inside the matrix.
+             * @param g boolean matrix.
+             * @param out receives the path, after its current contents.
+             * 
+             * @return the number of points appended, zero if no path exists
+             *         or the matrix loops.
+             */
+            size_t find_path(
+                const Point& source,
+                const Point& target,
+                Grid<bool>& g,
+                path_t& out
+            );
+
+            /**
+             * Finds the waypoints of a path between two points on a boolean
+             * matrix, i.e. the entrances it goes through, without refining
+             * them. Consecutive waypoints are either on the same cluster or
+             * next to each other.
+             * 
+             * @param source starting point, inside the matrix.
+             * @param target goal point, inside the matrix.
+             * @param g boolean matrix.
+             * @param out receives the waypoints, after its current contents.
+             * 
+             * @return the number of waypoints appended, zero if no path
+             *         exists or the matrix loops.
+             */
+            size_t find_waypoints(
+                const Point& source,
+                const Point& target,
+                Grid<bool>& g,
+                path_t& out
+            );
+
+            /**
+             * Refines a segment between two consecutive waypoints into a
+             * path.
+             * 
+             * @param from first waypoint.
+             * @param to second waypoint.
+             * @param g boolean matrix the waypoints were found on.
+             * @param out receives the path, after its current contents,
+             *        without its first point.
+             * 
+             * @return the number of points appended, zero if there is no
+             *         path between the waypoints.
+             */
+            size_t refine(
+                const Point& from,
+                const Point& to,
+                Grid<bool>& g,
+                path_t& out
+            );
+
+        private:
+            static constexpr int MAX_ENTRANCE_WIDTH = 6;
+
+            struct Entrance {
+                Point cell;
+                Point partners[4];
+                int partner_count;
+            };
+
+            struct Cluster {
+                int left;
+                int top;
+                int width;
+                int height;
+
+                std::vector<Entrance> entrances;
+
+                /**
+                 * Length of the path between every pair of entrances, row
+                 * by row, or infinity if there is none.
+                 */
+                std::vector<float> costs;
+
+                bool dirty;
+            };
+
+            struct Node {
+                float gvalue;
+                uint32_t link;
+            };
+
+            /**
+             * Free cell a search leaves its source or enters its target
+             * from: the point itself, or one of its neighbors if blocked.
+             */
+            struct Port {
+                Point cell;
+                int cluster;
+
+                /**
+                 * Length of the step between the port and its point.
+                 */
+                float cost = 0;
+
+                /**
+                 * Offset of the port's local costs on the search.
+                 */
+                size_t costs = 0;
+            };
+
+            struct SearchNode {
+                float fvalue;
+                uint32_t cell;
+
+                bool operator>(const SearchNode& other) const {
+                    return fvalue > other.fvalue;
+                }
+            };
+
+            int m_cluster_size;
+            int m_width = 0;
+            int m_height = 0;
+            int m_columns = 0;
+
+            std::vector<bits::word_t> m_snapshot;
+            std::vector<Cluster> m_clusters;
+
+            REAStarSolver m_solver;
+            Grid<bool> m_local = Grid<bool>(0, 0, nullptr);
+            path_t m_buffer;
+            path_t m_waypoints;
+
+            StampedGrid<Node> m_nodes;
+            std::vector<SearchNode> m_open;
+            std::vector<Port> m_starts;
+            std::vector<Port> m_ends;
+
+            /**
+             * Length of the path from each start port to every entrance on
+             * its cluster, then to every end port.
+             */
+            std::vector<float> m_start_costs;
+
+            /**
+             * Length of the path from every entrance on the cluster of each
+             * end port to it.
+             */
+            std::vector<float> m_end_costs;
+
+            void sync(Grid<bool>& g);
+            void rebuild(Cluster& cluster, Grid<bool>& g);
+            void add_entrances(
+                Cluster& cluster,
+                Grid<bool>& g,
+                Cardinal side
+            );
+
+            void add_entrance(Cluster& cluster, Point cell, Point partner);
+            void add_ports(
+                const Point& p,
+                Grid<bool>& g,
+                std::vector<Port>& out
+            );
+
+            void load_local(const Cluster& cluster, Grid<bool>& g);
+
+            /**
+             * Frees a cell on the local copy of a cluster, for a search
+             * starting or ending on it.
+             */
+            void open_local(const Cluster& cluster, const Point& p);
+            float local_cost(const Cluster& cluster, Point from, Point to);
+            size_t refine_segment(
+                const Point& from,
+                const Point& to,
+                Grid<bool>& g,
+                path_t& out
+            );
+
+            int cluster_index(const Point& p) const {
+                return p.y / m_cluster_size * m_columns + p.x / m_cluster_size;
+            }
+
+            int entrance_index(const Cluster& cluster, const Point& p) const;
+
+            uint32_t index(const Point& p) const {
+                return p.y * m_width + p.x;
+            }
+
+            Point point(uint32_t index) const {
+                return Point {
+                    .x = int(index % m_width),
+                    .y = int(index / m_width)
+                };
+            }
+    };
+};
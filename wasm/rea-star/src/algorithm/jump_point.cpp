@@ -0,0 +1,354 @@
+#include "jump_point.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+
+using namespace rea_star;
+
+namespace rea_star {
+    /**
+     * @return the solver shared by jump point searches on the current thread.
+     */
+    JumpPointSolver& jump_point_solver() {
+        thread_local JumpPointSolver solver;
+        return solver;
+    }
+
+    int sign(int v) {
+        return (v > 0) - (v < 0);
+    }
+};
+
+size_t JumpPointSolver::find_path(
+    const Point& source,
+    const Point& target,
+    Grid<bool>& g,
+    path_t& out,
+    int maxlen,
+    SearchStats* stats
+) {
+    // Jump distances stop at the edges of the grid, and the second copy of
+    // a looping map is no place to send anyone.
+    if (g.loops()) return 0;
+
+    sync(g);
+
+    m_nodes.reset(m_width, m_height, Node {
+        .gvalue = INFINITY,
+        .link = index(source)
+    });
+
+    m_nodes[source].gvalue = 0;
+
+    m_open.clear();
+    m_open.push_back(SearchNode {
+        .fvalue = float(octile(source, target)),
+        .cell = index(source)
+    });
+
+    Point best = source;
+    double best_hvalue = octile(source, target);
+
+    while (!m_open.empty()) {
+        std::pop_heap(m_open.begin(), m_open.end(), std::greater<SearchNode>());
+        SearchNode next = m_open.back();
+        m_open.pop_back();
+
+        Point p = point(next.cell);
+        Node node = m_nodes[p];
+        if (next.fvalue > node.gvalue + octile(p, target) + 1e-3f) continue;
+
+        if (p == target) {
+            best = target;
+            break;
+        }
+
+        if (stats) stats->expansions++;
+
+        int mask = p == source ? 0xff : directions(p, point(node.link));
+
+        for (int d = 0; d < DIRECTIONS; d++) {
+            if (!(mask & (1 << d))) continue;
+
+            int distance = jump(p.x, p.y, d),
+                dx = target.x - p.x,
+                dy = target.y - p.y;
+
+            // Moves towards the target stop next to it, or where it can be
+            // reached with a straight move for diagonal ones.
+            int steps = 0;
+            if (sign(dx) == DX[d] && sign(dy) == DY[d]) {
+                int k = DX[d] == 0 ? std::abs(dy)
+                      : DY[d] == 0 ? std::abs(dx)
+                      : std::min(std::abs(dx), std::abs(dy));
+
+                if (k <= std::abs(distance)) steps = k;
+            }
+
+            if (steps == 0 && distance > 0) steps = distance;
+            if (steps == 0) continue;
+
+            Point q = { .x = p.x + DX[d] * steps, .y = p.y + DY[d] * steps };
+            float gvalue = node.gvalue + float(octile(p, q));
+            if (gvalue >= maxlen) continue;
+
+            Node& qnode = m_nodes[q];
+            if (gvalue >= qnode.gvalue) continue;
+
+            qnode.gvalue = gvalue;
+            qnode.link = next.cell;
+
+            double hvalue = octile(q, target);
+            if (hvalue < best_hvalue) {
+                best = q;
+                best_hvalue = hvalue;
+            }
+
+            m_open.push_back(SearchNode {
+                .fvalue = gvalue + float(hvalue),
+                .cell = index(q)
+            });
+
+            std::push_heap(
+                m_open.begin(),
+                m_open.end(),
+                std::greater<SearchNode>()
+            );
+        }
+    }
+
+    size_t start = out.size();
+
+    for (Point current = best; current != source;) {
+        out.push_back(current);
+        current = point(m_nodes[current].link);
+    }
+
+    out.push_back(source);
+
+    std::reverse(out.begin() + start, out.end());
+    return out.size() - start;
+}
+
+int JumpPointSolver::directions(const Point& p, const Point& parent) const {
+    int dx = sign(p.x - parent.x),
+        dy = sign(p.y - parent.y);
+
+    int d = 0;
+    while (DX[d] != dx || DY[d] != dy) d++;
+
+    // Diagonal moves can't have forced neighbors without cutting corners.
+    if (dx != 0 && dy != 0) {
+        return 1 << d
+            | 1 << (d + DIRECTIONS - 1) % DIRECTIONS
+            | 1 << (d + 1) % DIRECTIONS;
+    }
+
+    int mask = 1 << d;
+    for (int turn : { 2, DIRECTIONS - 2 }) {
+        int side = (d + turn) % DIRECTIONS;
+        if (!free(p.x + DX[side], p.y + DY[side])) continue;
+        if (free(p.x - dx + DX[side], p.y - dy + DY[side])) continue;
+
+        mask |= 1 << side;
+        mask |= 1 << (d + (turn == 2 ? 1 : DIRECTIONS - 1)) % DIRECTIONS;
+    }
+
+    return mask;
+}
+
+bool JumpPointSolver::jump_point(int x, int y, int d) const {
+    for (int turn : { 2, DIRECTIONS - 2 }) {
+        int side = (d + turn) % DIRECTIONS;
+        if (
+            free(x + DX[side], y + DY[side])
+            && !free(x - DX[d] + DX[side], y - DY[d] + DY[side])
+        ) return true;
+    }
+
+    return false;
+}
+
+void JumpPointSolver::sync(Grid<bool>& g) {
+    int words = bits::words(g.width());
+    bool resized = g.width() != m_width || g.height() != m_height;
+
+    if (resized) {
+        m_width = g.width();
+        m_height = g.height();
+        m_words = words;
+
+        m_snapshot.assign(words * m_height, 0);
+        m_jumps.assign(m_width * m_height * DIRECTIONS, 0);
+        m_dirty_rows.assign(m_height, false);
+        m_dirty_cols.assign(m_width, false);
+    }
+
+    bool changed = resized;
+
+    for (int y = 0; y < m_height; y++) {
+        const bits::word_t* row = g.row(y);
+        bits::word_t* snapshot = m_snapshot.data() + y * words;
+
+        for (int w = 0; w < words; w++) {
+            bits::word_t diff = row[w] ^ snapshot[w];
+            if (diff == 0) continue;
+
+            snapshot[w] = row[w];
+            changed = true;
+
+            if (resized) continue;
+
+            // Jump points depend on the cells on both sides of a line.
+            for (; diff != 0; diff &= diff - 1) {
+                int x = w * bits::WORD_BITS + __builtin_ctzll(diff);
+
+                for (int i = y - 1; i <= y + 1; i++) {
+                    if (i >= 0 && i < m_height) m_dirty_rows[i] = true;
+                }
+
+                for (int i = x - 1; i <= x + 1; i++) {
+                    if (i >= 0 && i < m_width) m_dirty_cols[i] = true;
+                }
+            }
+        }
+    }
+
+    if (!changed) return;
+
+    // Diagonal jumps depend on straight ones.
+    if (resized) {
+        for (int d = 0; d < DIRECTIONS; d += 2) sweep(d);
+        for (int d = 1; d < DIRECTIONS; d += 2) sweep(d);
+        return;
+    }
+
+    for (int d = 0; d < DIRECTIONS; d += 2) {
+        bool horizontal = DY[d] == 0;
+        int lines = horizontal ? m_height : m_width;
+
+        for (int i = 0; i < lines; i++) {
+            if (horizontal ? !m_dirty_rows[i] : !m_dirty_cols[i]) continue;
+
+            int x = horizontal ? (DX[d] > 0 ? m_width - 1 : 0) : i,
+                y = horizontal ? i : (DY[d] > 0 ? m_height - 1 : 0);
+
+            for (; inside(x, y); x -= DX[d], y -= DY[d]) {
+                jump(x, y, d) = compute(x, y, d);
+            }
+        }
+    }
+
+    // Diagonal jumps stop wherever a straight one finds a jump point, so
+    // changes on a line spread back along every diagonal crossing it.
+    std::vector<int> columns;
+    for (int x = 0; x < m_width; x++) {
+        if (m_dirty_cols[x]) columns.push_back(x);
+    }
+
+    for (int d = 1; d < DIRECTIONS; d += 2) {
+        for (int j = 0; j < m_height; j++) {
+            int y = DY[d] > 0 ? m_height - 1 - j : j;
+            int count = m_dirty_rows[y] ? m_width : columns.size();
+
+            for (int i = 0; i < count; i++) {
+                int k = DX[d] > 0 ? count - 1 - i : i;
+                propagate(m_dirty_rows[y] ? k : columns[k], y, d);
+            }
+        }
+    }
+
+    m_dirty_rows.assign(m_height, false);
+    m_dirty_cols.assign(m_width, false);
+}
+
+int JumpPointSolver::compute(int x, int y, int d) const {
+    int nx = x + DX[d],
+        ny = y + DY[d];
+
+    int distance;
+    if (DX[d] == 0 || DY[d] == 0) {
+        if (!free(nx, ny)) return 0;
+        if (jump_point(nx, ny, d)) return 1;
+
+        distance = jump(nx, ny, d);
+    } else {
+        if (!free(nx, ny) || !free(nx, y) || !free(x, ny)) return 0;
+
+        int horizontal = DX[d] > 0 ? 2 : 6,
+            vertical = DY[d] > 0 ? 4 : 0;
+
+        if (jump(nx, ny, horizontal) > 0 || jump(nx, ny, vertical) > 0) {
+            return 1;
+        }
+
+        distance = jump(nx, ny, d);
+    }
+
+    return distance > 0 ? distance + 1 : distance - 1;
+}
+
+void JumpPointSolver::sweep(int d) {
+    // Visits cells so that the next one towards the direction comes first.
+    for (int j = 0; j < m_height; j++) {
+        int y = DY[d] > 0 ? m_height - 1 - j : j;
+
+        for (int i = 0; i < m_width; i++) {
+            int x = DX[d] > 0 ? m_width - 1 - i : i;
+            jump(x, y, d) = compute(x, y, d);
+        }
+    }
+}
+
+void JumpPointSolver::propagate(int x, int y, int d) {
+    // The cell before a changed one also depends on its straight jumps, so
+    // it is recomputed even if the changed cell keeps its diagonal jump.
+    for (bool first = true; inside(x, y); x -= DX[d], y -= DY[d]) {
+        int16_t distance = compute(x, y, d);
+        if (!first && jump(x, y, d) == distance) break;
+
+        jump(x, y, d) = distance;
+        first = false;
+    }
+}
+
+size_t rea_star::jump_point_search(
+    Point source,
+    Point target,
+    Grid<bool>& g,
+    path_t& out,
+    int maxlen,
+    SearchStats* stats
+) {
+    out.clear();
+    return jump_point_solver().find_path(
+        source,
+        target,
+        g,
+        out,
+        maxlen,
+        stats
+    );
+}
+
+double rea_star::corridor_ratio(Grid<bool>& g) {
+    int free = 0, corridors = 0;
+
+    for (int y = 0; y < g.height(); y++) {
+        for (int x = 0; x < g.width(); x++) {
+            if (!g[{ .x = x, .y = y }]) continue;
+
+            int neighbors = (x > 0 && g[{ .x = x - 1, .y = y }])
+                + (y > 0 && g[{ .x = x, .y = y - 1 }])
+                + (x + 1 < g.width() && g[{ .x = x + 1, .y = y }])
+                + (y + 1 < g.height() && g[{ .x = x, .y = y + 1 }]);
+
+            free++;
+            if (neighbors <= 2) corridors++;
+        }
+    }
+
+    return free == 0 ? 0 : double(corridors) / free;
+}
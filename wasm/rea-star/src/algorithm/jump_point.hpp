@@ -0,0 +1,179 @@
+/**
+ * @file jump_point.hpp
+ * 
+ * @author Brandt
+ * @date 2020/10/15
+ * @license Zlib
+ * 
+ * Jump point search (JPS+) definitions.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "rea_star.hpp"
+
+#include "../data/bits.hpp"
+#include "../data/grid.hpp"
+#include "../data/stamped_grid.hpp"
+
+namespace rea_star {
+    /**
+     * Reusable jump point search (JPS+) context.
+     * 
+     * The solver precomputes, for every cell and each of the 8 directions,
+     * how far a search moving that way can go before reaching a jump point
+     * (i.e. a cell where an optimal path might turn) or a blocked cell.
+     * Searches then only generate jump points, which makes them fast on maps
+     * made of narrow corridors, where REA* can't expand large rectangles.
+     * 
+     * Diagonal steps may not cut corners. The distances are kept between
+     * searches along with a copy of the grid they were computed for, and only
+     * the lines around cells that changed are recomputed on the next search.
+     */
+    class JumpPointSolver {
+        public:
+            JumpPointSolver() = default;
+
+            /**
+             * Finds the shortest path between two points on a boolean
+             * matrix. Consecutive points on the path are on the same row,
+             * column or diagonal.
+             * 
+             * @param source starting point.
+             * @param target goal point.
+             * @param g boolean matrix.
+             * @param out receives the path, after its current contents. If
+             *        the target can't be reached, it receives the path to the
+             *        closest point found instead.
+             * @param maxlen maximum length of the path.
+             * @param stats if not null, receives counters for the search.
+             * 
+             * @return the number of points appended, zero on looping grids,
+             *         which JPS+ doesn't search across.
+             */
+            size_t find_path(
+                const Point& source,
+                const Point& target,
+                Grid<bool>& g,
+                path_t& out,
+                int maxlen = DEFAULT_PATH_MAXLEN,
+                SearchStats* stats = nullptr
+            );
+
+        private:
+            /**
+             * Number of search directions, ordered clockwise from north.
+             */
+            static constexpr int DIRECTIONS = 8;
+
+            static constexpr int DX[DIRECTIONS] = { 0, 1, 1, 1, 0, -1, -1, -1 };
+            static constexpr int DY[DIRECTIONS] = { -1, -1, 0, 1, 1, 1, 0, -1 };
+
+            struct Node {
+                float gvalue;
+                uint32_t link;
+            };
+
+            struct SearchNode {
+                float fvalue;
+                uint32_t cell;
+
+                bool operator>(const SearchNode& other) const {
+                    return fvalue > other.fvalue;
+                }
+            };
+
+            int m_width = 0;
+            int m_height = 0;
+            int m_words = 0;
+
+            std::vector<bits::word_t> m_snapshot;
+
+            /**
+             * Jump distance for each cell and direction, cell by cell. A
+             * positive distance leads to a jump point, otherwise its absolute
+             * value is how many steps can be taken before hitting a blocked
+             * cell.
+             */
+            std::vector<int16_t> m_jumps;
+
+            std::vector<bool> m_dirty_rows;
+            std::vector<bool> m_dirty_cols;
+
+            StampedGrid<Node> m_nodes;
+            std::vector<SearchNode> m_open;
+
+            void sync(Grid<bool>& g);
+            int compute(int x, int y, int d) const;
+            void sweep(int d);
+            void propagate(int x, int y, int d);
+
+            bool jump_point(int x, int y, int d) const;
+            int directions(const Point& p, const Point& parent) const;
+
+            bool inside(int x, int y) const {
+                return x >= 0 && y >= 0 && x < m_width && y < m_height;
+            }
+
+            bool free(int x, int y) const {
+                return inside(x, y)
+                    && (m_snapshot[y * m_words + x / bits::WORD_BITS]
+                        & bits::bit(x));
+            }
+
+            int16_t& jump(int x, int y, int d) {
+                return m_jumps[(x + y * m_width) * DIRECTIONS + d];
+            }
+
+            int jump(int x, int y, int d) const {
+                return m_jumps[(x + y * m_width) * DIRECTIONS + d];
+            }
+
+            uint32_t index(const Point& p) const {
+                return p.y * m_width + p.x;
+            }
+
+            Point point(uint32_t index) const {
+                return Point {
+                    .x = int(index % m_width),
+                    .y = int(index / m_width)
+                };
+            }
+    };
+
+    /**
+     * Applies JPS+ to find the shortest path between two points on a boolean
+     * matrix, with a solver shared by searches on the current thread.
+     * 
+     * @param source starting point.
+     * @param target goal point.
+     * @param g boolean matrix.
+     * @param out receives the path, replacing its contents.
+     * @param maxlen maximum length of the path.
+     * @param stats if not null, receives counters for the search.
+     * 
+     * @return the number of points on the path.
+     */
+    size_t jump_point_search(
+        Point source,
+        Point target,
+        Grid<bool>& g,
+        path_t& out,
+        int maxlen = DEFAULT_PATH_MAXLEN,
+        SearchStats* stats = nullptr
+    );
+
+    /**
+     * Measures how much a boolean matrix looks like a maze, to choose between
+     * REA* and JPS+ for it.
+     * 
+     * @param g boolean matrix.
+     * 
+     * @return the fraction of free cells with at most two free orthogonal
+     *         neighbors, i.e. cells on corridors or dead ends.
+     */
+    double corridor_ratio(Grid<bool>& g);
+};
@@ -0,0 +1,138 @@
+#include "path_cache.hpp"
+
+#include <algorithm>
+
+using namespace rea_star;
+
+namespace rea_star {
+    /**
+     * @return whether a point is on the segment between two others, as
+     *         walked by a character following a path.
+     */
+    bool on_segment(const Point& p, const Point& a, const Point& b) {
+        if (p.x < std::min(a.x, b.x) || p.x > std::max(a.x, b.x)) return false;
+        if (p.y < std::min(a.y, b.y) || p.y > std::max(a.y, b.y)) return false;
+
+        return octile(a, p) + octile(p, b) <= octile(a, b) + 1e-6;
+    }
+};
+
+size_t PathCache::find_path(
+    const Point& source,
+    const Point& target,
+    Grid<bool>& g,
+    path_t& out,
+    int maxlen
+) {
+    sync(g);
+
+    for (Entry& entry : m_entries) {
+        const path_t& path = entry.path;
+        if (path.empty() || path.back() != target) continue;
+
+        for (size_t i = 0; i < path.size(); i++) {
+            bool reached = i + 1 == path.size()
+                ? path[i] == source
+                : on_segment(source, path[i], path[i + 1]);
+
+            if (!reached) continue;
+
+            double length = 0;
+            Point previous = source;
+            for (size_t j = i + 1; j < path.size(); j++) {
+                length += octile(previous, path[j]);
+                previous = path[j];
+            }
+
+            if (length >= maxlen) break;
+
+            size_t start = out.size();
+            out.push_back(source);
+            out.insert(out.end(), path.begin() + i + 1, path.end());
+
+            entry.used = ++m_clock;
+            return out.size() - start;
+        }
+    }
+
+    return 0;
+}
+
+void PathCache::insert(
+    path_t::const_iterator begin,
+    path_t::const_iterator end,
+    Grid<bool>& g
+) {
+    if (begin == end || g.loops()) return;
+
+    sync(g);
+
+    // Paths between the same points replace each other, then empty slots
+    // are filled before the least recently used path is dropped.
+    Entry* slot = nullptr;
+    for (Entry& entry : m_entries) {
+        const path_t& path = entry.path;
+        if (!path.empty() && path.front() == *begin && path.back() == end[-1]) {
+            slot = &entry;
+            break;
+        }
+    }
+
+    if (!slot && m_entries.size() < m_capacity) {
+        slot = &m_entries.emplace_back();
+    }
+
+    if (!slot) {
+        slot = &m_entries.front();
+        for (Entry& entry : m_entries) {
+            if (entry.used < slot->used) slot = &entry;
+        }
+    }
+
+    slot->path.assign(begin, end);
+    slot->used = ++m_clock;
+}
+
+void PathCache::clear() {
+    for (Entry& entry : m_entries) drop(entry);
+}
+
+void PathCache::sync(const Grid<bool>& g) {
+    if (&g == m_grid && g.version() == m_version) return;
+
+    // Characters only walk a path within the boxes of its segments, so
+    // changes elsewhere leave it valid.
+    auto check = [&](const Grid<bool>::Change& change) {
+        for (Entry& entry : m_entries) {
+            const path_t& path = entry.path;
+
+            for (size_t i = 0; i + 1 < path.size(); i++) {
+                const Point& a = path[i];
+                const Point& b = path[i + 1];
+
+                bool crossed = change.overlaps(
+                    std::min(a.x, b.x),
+                    std::min(a.y, b.y),
+                    std::max(a.x, b.x),
+                    std::max(a.y, b.y)
+                );
+
+                if (crossed) {
+                    drop(entry);
+                    break;
+                }
+            }
+        }
+    };
+
+    bool known = &g == m_grid && g.for_each_change(m_version, check);
+
+    m_grid = &g;
+    m_version = g.version();
+    if (!known) clear();
+}
+
+void PathCache::drop(Entry& entry) {
+    entry.path.clear();
+    entry.used = 0;
+}
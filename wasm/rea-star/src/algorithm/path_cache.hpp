@@ -0,0 +1,108 @@
+/**
+ * @file path_cache.hpp
+ * 
+ * @author Brandt
+ * @date 2020/10/16
+ * @license Zlib
+ * 
+ * Cache of paths found on a grid.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "rea_star.hpp"
+
+#include "../data/grid.hpp"
+
+namespace rea_star {
+    /**
+     * Default number of paths kept by a cache.
+     */
+    constexpr size_t DEFAULT_PATH_CACHE_CAPACITY = 64;
+
+    /**
+     * Least recently used cache of complete paths on a boolean matrix, keyed
+     * by their targets.
+     * 
+     * A query hits a cached path to the same target if its source is on any
+     * segment of it, i.e. within the box between two consecutive points and
+     * no further from them than they are from each other. Followers walking
+     * along a path, or standing anywhere along the path of another character
+     * chasing the same target, reuse its remainder without a new search.
+     * 
+     * The cache follows a single matrix, and is emptied whenever it is used
+     * with another one. When cells of the matrix change, only the paths with
+     * a segment whose box covers them are dropped, unless the changes are too
+     * old for the matrix to remember. Paths on looping matrices are not
+     * cached, since their segments may cross the seams.
+     */
+    class PathCache {
+        public:
+            /**
+             * @param capacity maximum number of paths kept.
+             */
+            explicit PathCache(size_t capacity = DEFAULT_PATH_CACHE_CAPACITY):
+                m_capacity(capacity) {};
+
+            /**
+             * Looks for a cached path from a point to a target.
+             * 
+             * @param source starting point.
+             * @param target goal point.
+             * @param g boolean matrix.
+             * @param out receives the path, after its current contents.
+             * @param maxlen maximum length of the path.
+             * 
+             * @return the number of points appended, zero on a miss.
+             */
+            size_t find_path(
+                const Point& source,
+                const Point& target,
+                Grid<bool>& g,
+                path_t& out,
+                int maxlen = DEFAULT_PATH_MAXLEN
+            );
+
+            /**
+             * Stores a complete path, replacing the least recently used one
+             * if the cache is full.
+             * 
+             * @param begin first point of the path.
+             * @param end end of the path.
+             * @param g boolean matrix the path was found on.
+             */
+            void insert(
+                path_t::const_iterator begin,
+                path_t::const_iterator end,
+                Grid<bool>& g
+            );
+
+            /**
+             * Drops every cached path.
+             */
+            void clear();
+
+        private:
+            struct Entry {
+                path_t path;
+                uint64_t used;
+            };
+
+            size_t m_capacity;
+            std::vector<Entry> m_entries;
+
+            const Grid<bool>* m_grid = nullptr;
+            uint32_t m_version = 0;
+            uint64_t m_clock = 0;
+
+            void sync(const Grid<bool>& g);
+
+            /**
+             * Drops a cached path, leaving its slot free.
+             */
+            static void drop(Entry& entry);
+    };
+};
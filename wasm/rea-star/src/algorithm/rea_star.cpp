@@ -1,38 +1,20 @@
 #include "rea_star.hpp"
 
 #include <algorithm>
-#include <queue>
+#include <cassert>
+#include <iterator>
 #include <cmath>
 
 #include "../data/grid.hpp"
 #include "../data/interval.hpp"
 #include "../data/rect.hpp"
 
-namespace rea_star {
-    enum class NodeType {
-        GPOINT,
-        HPOINT
-    };
-
-    struct Node {
-        NodeType type;
-        double gvalue;
-        double hvalue;
-    };
-
-    struct SearchNode {
-        Interval interval;
-        Point min_point;
-        double minfval;
-
-        bool operator>(const SearchNode& other) const {
-            return minfval > other.minfval;
-        }
-    };
+using namespace rea_star;
 
+namespace rea_star {
     constexpr double SQRT2 = 1.414;
 
-    [[gnu::hot, gnu::const]]
+    [[gnu::hot, gnu::pure]]
     double octile(const Point& a, const Point& b) {
         double dx = std::abs(a.x - b.x),
                dy = std::abs(a.y - b.y);
@@ -40,214 +22,609 @@ namespace rea_star {
         return SQRT2 * std::min(dx, dy) + std::abs(dx - dy);
     }
 
-    class REAStarSolver {
-        public:
-            REAStarSolver(
-                const Point& source,
-                const Point& target,
-                const Grid<bool>& g,
-                int maxlen
-            ): m_source(source),
-                m_target(target),
-                m_g(g),
-                m_nodes(
-                    g.width(),
-                    g.height(),
-                    Node {
-                        .type = NodeType::GPOINT,
-                        .gvalue = INFINITY
-                    }
-                ),
-                m_parents(g.width(), g.height(), source),
-                m_maxlen(maxlen),
-                m_best(source),
-                m_best_hval(octile(source, target)) {}
-
-            std::optional<path_t> find_path() {
-                auto path = insert_start();
-                if (path.has_value()) return path;
-
-                while (!m_open.empty()) {
-                    SearchNode next = m_open.top();
-                    m_open.pop();
-
-                    path = expand(next);
-                    if (path.has_value()) return path;
+    /**
+     * Maps a path found on the window of a looping grid back onto the map,
+     * splitting its segments so that none of them spans half the map or
+     * more along an axis it loops on. Characters walk towards the nearest
+     * copy of their next point, which is then always the one the segment
+     * leads to.
+     * 
+     * @param g looping grid.
+     * @param out path buffer.
+     * @param start offset of the path on the buffer.
+     */
+    void wrap_path(const Grid<bool>& g, path_t& out, size_t start) {
+        path_t points(out.begin() + start, out.end());
+        out.resize(start);
+
+        int half_width = std::max(g.map_width() / 2, 1),
+            half_height = std::max(g.map_height() / 2, 1);
+
+        for (size_t i = 0; i < points.size(); i++) {
+            if (i > 0) {
+                Point a = points[i - 1],
+                      b = points[i];
+
+                int dx = b.x - a.x,
+                    dy = b.y - a.y;
+
+                int pieces = 1 + std::max(
+                    g.topology().loop_x ? std::abs(dx) / half_width : 0,
+                    g.topology().loop_y ? std::abs(dy) / half_height : 0
+                );
+
+                for (int j = 1; j < pieces; j++) {
+                    out.push_back(g.wrap(Point {
+                        .x = a.x + dx * j / pieces,
+                        .y = a.y + dy * j / pieces
+                    }));
                 }
-
-                m_target = m_best;
-                return build_path();
             }
-            
-        private:
-            Point m_source;
-            Point m_target;
-            Grid<bool> m_g;
-            Grid<Node> m_nodes;
-            Grid<Point> m_parents;
-            int m_maxlen;
-
-            Point m_best;
-            double m_best_hval;
-
-            std::priority_queue<
-                SearchNode,
-                std::vector<SearchNode>,
-                std::greater<SearchNode>
-            > m_open;
-            
-            std::optional<path_t> insert_start() {
-                auto rect = Rect::expand_point(m_source, m_g);
-                if (rect.contains(m_target)) {
-                    return path_t { m_source, m_target };
-                }
 
-                for (const Point& p : rect.boundaries()) {
+            out.push_back(g.wrap(points[i]));
+        }
+    }
+
+    /**
+     * @return the solver for a policy shared by searches on the current
+     *         thread.
+     */
+    template <typename Policy = DefaultPolicy>
+    BasicREAStarSolver<Policy>& solver() {
+        thread_local BasicREAStarSolver<Policy> solver;
+        return solver;
+    }
+};
+
+template <typename Policy>
+std::optional<path_t> BasicREAStarSolver<Policy>::find_path(
+    const Point& source,
+    const Point& target,
+    Grid<bool>& g,
+    int maxlen,
+    SearchStats* stats
+) {
+    path_t path;
+    if (find_path(source, target, g, path, maxlen, stats) == 0) {
+        return std::nullopt;
+    }
+
+    return path;
+}
+
+template <typename Policy>
+size_t BasicREAStarSolver<Policy>::find_path(
+    const Point& source,
+    const Point& target,
+    Grid<bool>& g,
+    path_t& out,
+    int maxlen,
+    SearchStats* stats
+) {
+    begin(source, target, g, maxlen, stats);
+    step(INT32_MAX);
+
+    return path(out);
+}
+
+template <typename Policy>
+size_t BasicREAStarSolver<Policy>::find_path(
+    const Point& source,
+    const std::vector<Point>& targets,
+    Grid<bool>& g,
+    path_t& out,
+    int maxlen,
+    SearchStats* stats
+) {
+    if (targets.empty()) return 0;
+
+    begin(source, targets, g, maxlen, stats);
+    step(INT32_MAX);
+
+    return path(out);
+}
+
+template <typename Policy>
+void BasicREAStarSolver<Policy>::begin(
+    const Point& source,
+    const Point& target,
+    Grid<bool>& g,
+    int maxlen,
+    SearchStats* stats
+) {
+    m_targets.assign(1, target);
+    start(source, g, maxlen, stats);
+}
+
+template <typename Policy>
+void BasicREAStarSolver<Policy>::begin(
+    const Point& source,
+    const std::vector<Point>& targets,
+    Grid<bool>& g,
+    int maxlen,
+    SearchStats* stats
+) {
+    assert(!targets.empty());
+
+    m_targets.assign(targets.begin(), targets.end());
+    start(source, g, maxlen, stats);
+}
+
+template <typename Policy>
+SearchStatus BasicREAStarSolver<Policy>::step(int max_expansions) {
+#ifdef REA_STAR_STATS
+    StatsScope scope(m_stats);
+#endif
+
+    for (int i = 0; i < max_expansions; i++) {
+        if (m_status != SearchStatus::IN_PROGRESS) break;
+        next();
+    }
+
+    return m_status;
+}
+
+template <typename Policy>
+SearchStatus BasicREAStarSolver<Policy>::step_for(
+    std::chrono::microseconds budget
+) {
+    using clock = std::chrono::steady_clock;
+
+#ifdef REA_STAR_STATS
+    StatsScope scope(m_stats);
+#endif
+
+    auto deadline = clock::now() + budget;
+    while (m_status == SearchStatus::IN_PROGRESS) {
+        next();
+        if (clock::now() >= deadline) break;
+    }
+
+    return m_status;
+}
+
+template <typename Policy>
+size_t BasicREAStarSolver<Policy>::path(path_t& out) const {
+    if constexpr (!Policy::PARTIAL) {
+        if (m_status != SearchStatus::FOUND) return 0;
+    }
+
+    size_t start = out.size();
+
+    Point target = m_status == SearchStatus::FOUND ? m_target : m_best;
+
+    Point current = target;
+    while (current != m_source) {
+        out.push_back(current);
+        current = point(m_nodes[current].parent());
+    }
+
+    out.push_back(m_source);
+
+    std::reverse(out.begin() + start, out.end());
+    if (m_g->loops()) wrap_path(*m_g, out, start);
+
+    return out.size() - start;
+}
+
+template <typename Policy>
+void BasicREAStarSolver<Policy>::start(
+    const Point& source,
+    Grid<bool>& g,
+    int maxlen,
+    SearchStats* stats
+) {
+    // Searches on looping grids run on a window around the source, towards
+    // whichever copy of each target is nearest, so that the heuristic is
+    // the distance around the map the shortest way.
+    if (g.loops()) {
+        m_images.clear();
+        for (const Point& target : m_targets) {
+            g.for_each_image(target, [&](const Point& p) {
+                m_images.push_back(p);
+            });
+        }
+
+        m_targets.swap(m_images);
+    }
+
+    m_source = g.loops() ? g.unwrap(source) : source;
+    m_target = m_targets.front();
+    m_g = &g;
+    m_maxlen = maxlen < costs::INFINITE / costs::UNIT
+        ? cost_t(maxlen) * costs::UNIT
+        : costs::INFINITE;
+    m_reached = costs::INFINITE;
+    m_best = m_source;
+    m_best_hval = hvalue(m_source);
+    m_stats = stats;
+
+    m_nodes.reset(g.width(), g.height(), Node {
+        .gvalue = costs::INFINITE,
+        .link = index(m_source)
+    });
+
+    m_open.reset(size_t(g.width()) * g.height() * std::size(CARDINALS));
+
+    m_status = SearchStatus::IN_PROGRESS;
+
+#ifdef REA_STAR_STATS
+    StatsScope scope(m_stats);
+#endif
+
+    if (insert_start()) m_status = SearchStatus::FOUND;
+    else settle();
+}
+
+template <typename Policy>
+void BasicREAStarSolver<Policy>::next() {
+    SearchNode node = m_open.priority(m_open.top());
+    m_open.pop();
+
+    if (expand(node)) m_status = SearchStatus::FOUND;
+    else settle();
+}
+
+template <typename Policy>
+void BasicREAStarSolver<Policy>::settle() {
+    bool reached = m_reached < costs::INFINITE;
+    if (
+        !m_open.empty()
+        && (!reached || m_open.priority(m_open.top()).minfval < m_reached)
+    ) return;
+
+    m_status = reached ? SearchStatus::FOUND : SearchStatus::FAILED;
+}
+
+template <typename Policy>
+bool BasicREAStarSolver<Policy>::insert_start() {
+#ifdef REA_STAR_STATS
+    std::optional<StatsTimer> timer(m_stats ? &m_stats->expand_us : nullptr);
+#endif
+
+    auto rect = Rect::expand_point(m_source, *m_g);
+
+#ifdef REA_STAR_STATS
+    timer.reset();
+#endif
+
+    if (reaches(rect, m_source, 0)) return true;
+
+    rect.for_each_boundary([&](const Point& p) {
+        m_nodes[p] = Node {
+            .gvalue = costs::octile(p, m_source),
+            .link = index(m_source)
+        };
+    });
+
+    for (Cardinal cardinal : CARDINALS) {
+        auto interval = rect.extend_neighbor_interval(cardinal);
+        if (!interval.is_valid(*m_g)) continue;
+
+        if (successor(interval)) return true;
+    }
+
+    return false;
+}
+
+template <typename Policy>
+bool BasicREAStarSolver<Policy>::successor(const Interval& interval) {
+#ifdef REA_STAR_STATS
+    StatsTimer timer(m_stats ? &m_stats->successor_us : nullptr);
+    if (m_stats) m_stats->subinterval_scans++;
+#endif
+
+    return interval.for_each_free_subinterval(*m_g, [&](const Interval& fsi) {
+        auto parent = fsi.parent();
+        bool updated = false;
+
+        for (int i = 0; i < fsi.length(); i++) {
+            Point p = fsi.at(i);
+            cost_t gvalue = m_nodes[p].gvalue;
+
+            for (int j = i - 1; j <= i + 1; j++) {
+                if (j < 0 || j >= fsi.length()) continue;
+
+                Point pp = parent.at(j);
+                cost_t d = costs::octile(p, pp);
+                cost_t pgvalue = m_nodes[pp].gvalue + d;
+
+                if (
+                    pgvalue < gvalue
+                    && within(pgvalue)
+                    && m_g->passable(pp, p)
+                ) {
+                    track(p);
+
+                    gvalue = pgvalue;
                     m_nodes[p] = Node {
-                        .type = NodeType::GPOINT,
-                        .gvalue = octile(p, m_source)
+                        .gvalue = gvalue,
+                        .link = index(pp) | Node::HPOINT
                     };
+
+                    updated = true;
                 }
+            }
+        }
 
-                for (Cardinal cardinal : CARDINALS) {
-                    auto interval = rect.extend_neighbor_interval(cardinal);
-                    if (!interval.is_valid(m_g)) continue;
+        if (reaches(fsi)) return true;
 
-                    auto path = successor(interval);
-                    if (path.has_value()) return path;
-                }
+        if (updated) open(fsi);
+        return false;
+    });
+}
 
-                return std::nullopt;
-            }
+template <typename Policy>
+bool BasicREAStarSolver<Policy>::expand(const SearchNode& node) {
+#ifdef REA_STAR_STATS
+    if (m_stats) m_stats->expansions++;
+#endif
 
-            std::optional<path_t> successor(const Interval& interval) {
-                for (const auto& fsi : interval.free_subintervals(m_g)) {
-                    auto parent = fsi.parent();
-                    bool updated = false;
-
-                    for (int i = 0; i < fsi.length(); i++) {
-                        Point p = fsi.at(i);
-                        double gvalue = m_nodes[p].gvalue;
-
-                        for (int j = i - 1; j <= i + 1; j++) {
-                            if (j < 0 || j >= fsi.length()) continue;
-
-                            Point pp = parent.at(j);
-                            double d = octile(p, pp);
-                            double pgvalue = m_nodes[pp].gvalue + d;
-
-                            if (pgvalue < gvalue && pgvalue < m_maxlen) {
-                                double h = octile(p, m_target);
-                                if (h < m_best_hval) {
-                                    m_best = p;
-                                    m_best_hval = h;
-                                }
-
-                                gvalue = pgvalue;
-                                m_parents[p] = pp;
-                                m_nodes[p] = Node {
-                                    .type = NodeType::HPOINT,
-                                    .gvalue = gvalue,
-                                    .hvalue = h
-                                };
-
-                                updated = true;
-                            }
-                        }
-                    }
-
-                    if (fsi.contains(m_target)) return build_path();
-
-                    if (updated) m_open.push(make_search_node(fsi));
-                }
+    auto interval = node.interval;
+    if (reaches(interval)) return true;
 
-                return std::nullopt;
-            }
+#ifdef REA_STAR_STATS
+    std::optional<StatsTimer> timer(m_stats ? &m_stats->expand_us : nullptr);
+#endif
+
+    auto rect = Rect::expand_interval(interval, *m_g);
+
+#ifdef REA_STAR_STATS
+    timer.reset();
+#endif
+    if (reaches(rect, node.min_point, m_nodes[node.min_point].gvalue)) {
+        return true;
+    }
+
+    for (const Interval& wall : rect.walls(interval.cardinal())) {
+        for (const Point& p : wall) {
+            for (const Point& pp : interval) {
+                cost_t d = costs::octile(p, pp);
+                cost_t pgvalue = m_nodes[pp].gvalue + d;
 
-            std::optional<path_t> expand(const SearchNode& node) {
-                auto interval = node.interval;
-                if (interval.contains(m_target)) return build_path();
+                Node& pnode = m_nodes[p];
 
-                auto rect = Rect::expand_interval(interval, m_g);
-                if (rect.contains(m_target)) {
-                    m_parents[m_target] = node.min_point;
-                    return build_path();
+                if (pgvalue < pnode.gvalue && within(pgvalue)) {
+                    track(p);
+
+                    pnode.gvalue = pgvalue;
+                    pnode.link = index(pp) | (pnode.link & Node::HPOINT);
                 }
+            }
+        }
 
-                for (const Interval& wall : rect.walls(interval.cardinal())) {
-                    for (const Point& p : wall) {
-                        for (const Point& pp : interval) {
-                            double d = octile(p, pp);
-                            double pgvalue = m_nodes[pp].gvalue + d;
+        auto eni = rect.extend_neighbor_interval(wall.cardinal());
+        if (!eni.is_valid(*m_g)) continue;
 
-                            Node pnode = m_nodes[p];
+        if (successor(eni)) return true;
+    }
 
-                            if (pgvalue < pnode.gvalue && pgvalue < m_maxlen) {
-                                double h = octile(p, m_target);
-                                if (h < m_best_hval) {
-                                    m_best = p;
-                                    m_best_hval = h;
-                                }
+    return false;
+}
 
-                                m_parents[p] = pp;
-                                m_nodes[p].gvalue = pgvalue;
-                            }
-                        }
-                    }
+template <typename Policy>
+typename BasicREAStarSolver<Policy>::estimate_t
+BasicREAStarSolver<Policy>::hvalue(const Point& p) const {
+    estimate_t h = estimates::INFINITE;
+    for (const Point& target : m_targets) {
+        h = std::min(h, heuristic::template estimate<estimate_t>(p, target));
+    }
 
-                    auto eni = rect.extend_neighbor_interval(wall.cardinal());
-                    if (!eni.is_valid(m_g)) continue;
+    return h;
+}
 
-                    auto path = successor(eni);
-                    if (path.has_value()) return path;
-                }
+template <typename Policy>
+template <typename Region>
+bool BasicREAStarSolver<Policy>::reaches(
+    const Region& region,
+    const Point& from,
+    cost_t gvalue
+) {
+    // Regions may hold several targets, e.g. more than one copy of the same
+    // target on looping grids, so each is linked straight to where the path
+    // enters the region.
+    for (const Point& target : m_targets) {
+        if (!region.contains(target)) continue;
+
+        cost_t tgvalue = gvalue + costs::octile(target, from);
+
+        Node& node = m_nodes[target];
+        if (tgvalue < node.gvalue) {
+            node.gvalue = tgvalue;
+            node.link = index(from) | (node.link & Node::HPOINT);
+        }
 
-                return std::nullopt;
-            }
+        reach(target);
+    }
 
-            path_t build_path() const {
-                path_t path;
-                path.reserve(m_g.width() * m_g.height() / 2);
-                
-                Point current = m_target;
-                while (current != m_source) {
-                    path.push_back(current);
-                    current = m_parents[current];
-                }
+    return m_targets.size() == 1 && m_reached < costs::INFINITE;
+}
 
-                path.push_back(m_source);
+template <typename Policy>
+bool BasicREAStarSolver<Policy>::reaches(const Interval& interval) {
+    for (const Point& target : m_targets) {
+        // Interval cells are only reached once they have a parent, corner
+        // cells of a neighbor interval might have none yet.
+        if (interval.contains(target)) reach(target);
+    }
 
-                std::reverse(path.begin(), path.end());
-                return path;
-            }
+    return m_targets.size() == 1 && m_reached < costs::INFINITE;
+}
 
-            SearchNode make_search_node(const Interval& interval) const {
-                Point min_point;
-                double minfval = INFINITY;
-
-                for (const auto& p : interval) {
-                    auto node = m_nodes[p];
-                    double fvalue = node.gvalue + node.hvalue;
-                    if (fvalue < minfval) {
-                        minfval = fvalue;
-                        min_point = p;
-                    }
-                }
+template <typename Policy>
+void BasicREAStarSolver<Policy>::reach(const Point& target) {
+    cost_t gvalue = m_nodes[target].gvalue;
+    if (gvalue < m_reached) {
+        m_reached = gvalue;
+        m_target = target;
+    }
+}
+
+template <typename Policy>
+typename BasicREAStarSolver<Policy>::SearchNode
+BasicREAStarSolver<Policy>::make_search_node(
+    const Interval& interval
+) const {
+    Point min_point;
+    cost_t minfval = costs::INFINITE;
+
+    for (const auto& p : interval) {
+        cost_t fvalue = cost_t(m_nodes[p].gvalue + hvalue(p));
+        if (fvalue < minfval) {
+            minfval = fvalue;
+            min_point = p;
+        }
+    }
 
-                return SearchNode {
-                    .interval = interval,
-                    .min_point = min_point,
-                    .minfval = minfval
-                };
-            }
+    return SearchNode {
+        .interval = interval,
+        .min_point = min_point,
+        .minfval = minfval
     };
-};
+}
+
+template <typename Policy>
+void BasicREAStarSolver<Policy>::open(const Interval& interval) {
+    uint32_t key = open_key(interval);
+    if (!m_open.contains(key)) {
+        m_open.push(key, make_search_node(interval));
+
+#ifdef REA_STAR_STATS
+        if (m_stats) {
+            int size = m_open.size();
 
-std::optional<rea_star::path_t> rea_star::rectangle_expansion_astar(
+            m_stats->pushes++;
+            m_stats->peak_open = std::max(m_stats->peak_open, size);
+        }
+#endif
+
+        return;
+    }
+
+    // Free intervals starting on the same cell and going the same way only
+    // differ on their ends, so the longest one covers both.
+    const Interval& queued = m_open.priority(key).interval;
+    const Interval& longest = queued.max() > interval.max() ? queued : interval;
+
+    m_open.update(key, make_search_node(longest));
+
+#ifdef REA_STAR_STATS
+    if (m_stats) m_stats->merged++;
+#endif
+}
+
+template <typename Policy>
+uint32_t BasicREAStarSolver<Policy>::open_key(
+    const Interval& interval
+) const {
+    uint32_t direction = 0;
+    switch (interval.cardinal()) {
+    case Cardinal::NORTH: direction = 0; break;
+    case Cardinal::SOUTH: direction = 1; break;
+    case Cardinal::EAST: direction = 2; break;
+    case Cardinal::WEST: direction = 3; break;
+    }
+
+    uint32_t cells = m_g->width() * m_g->height();
+    return direction * cells + index(interval.at(0));
+}
+
+template class rea_star::BasicREAStarSolver<DefaultPolicy>;
+template class rea_star::BasicREAStarSolver<CompletePolicy>;
+template class rea_star::BasicREAStarSolver<GreedyPolicy>;
+
+std::optional<path_t> rea_star::rectangle_expansion_astar(
     Point source,
     Point target,
-    const Grid<bool>& g,
-    int maxlen
+    Grid<bool>& g,
+    int maxlen,
+    SearchStats* stats
 ) {
-    return rea_star::REAStarSolver(source, target, g, maxlen).find_path();
-}
\ No newline at end of file
+    return solver().find_path(source, target, g, maxlen, stats);
+}
+
+void rea_star::rectangle_expansion_astar_batch(
+    const std::vector<PathQuery>& queries,
+    Grid<bool>& g,
+    PathBatch& batch
+) {
+    batch.points.clear();
+    batch.offsets.clear();
+    batch.offsets.push_back(0);
+
+    for (const PathQuery& query : queries) {
+        solver().find_path(
+            query.source,
+            query.target,
+            g,
+            batch.points,
+            query.maxlen
+        );
+
+        batch.offsets.push_back(batch.points.size());
+    }
+}
+
+size_t rea_star::rectangle_expansion_astar(
+    Point source,
+    Point target,
+    Grid<bool>& g,
+    path_t& out,
+    int maxlen,
+    SearchStats* stats
+) {
+    out.clear();
+    return solver().find_path(source, target, g, out, maxlen, stats);
+}
+
+size_t rea_star::rectangle_expansion_astar_nearest(
+    Point source,
+    const std::vector<Point>& targets,
+    Grid<bool>& g,
+    path_t& out,
+    int maxlen,
+    SearchStats* stats
+) {
+    out.clear();
+    return solver().find_path(source, targets, g, out, maxlen, stats);
+}
+
+template <typename Policy>
+size_t rea_star::rectangle_expansion_astar(
+    Point source,
+    Point target,
+    Grid<bool>& g,
+    path_t& out,
+    int maxlen,
+    SearchStats* stats
+) {
+    out.clear();
+    return solver<Policy>().find_path(source, target, g, out, maxlen, stats);
+}
+
+template size_t rea_star::rectangle_expansion_astar<DefaultPolicy>(
+    Point source,
+    Point target,
+    Grid<bool>& g,
+    path_t& out,
+    int maxlen,
+    SearchStats* stats
+);
+
+template size_t rea_star::rectangle_expansion_astar<CompletePolicy>(
+    Point source,
+    Point target,
+    Grid<bool>& g,
+    path_t& out,
+    int maxlen,
+    SearchStats* stats
+);
+
+template size_t rea_star::rectangle_expansion_astar<GreedyPolicy>(
+    Point source,
+    Point target,
+    Grid<bool>& g,
+    path_t& out,
+    int maxlen,
+    SearchStats* stats
+);
@@ -10,10 +10,18 @@
 
 #pragma once
 
+#include <chrono>
+#include <cstdint>
 #include <optional>
 #include <vector>
 
+#include "search_policy.hpp"
+#include "search_stats.hpp"
+
 #include "../data/grid.hpp"
+#include "../data/indexed_heap.hpp"
+#include "../data/interval.hpp"
+#include "../data/stamped_grid.hpp"
 
 namespace rea_star {
     /**
@@ -26,19 +34,456 @@ namespace rea_star {
      */
     constexpr int DEFAULT_PATH_MAXLEN = INT32_MAX;
 
+    /**
+     * Source and target for a path search.
+     */
+    struct PathQuery {
+        Point source;
+        Point target;
+        int maxlen = DEFAULT_PATH_MAXLEN;
+    };
+
+    /**
+     * Paths found for a batch of queries, flattened into a single buffer.
+     */
+    struct PathBatch {
+        /**
+         * Points for every path, one path after the other.
+         */
+        path_t points;
+
+        /**
+         * Offset of each path on the points buffer, followed by the size of
+         * the buffer. Queries without a path get an empty one.
+         */
+        std::vector<int32_t> offsets;
+    };
+
+    /**
+     * State of an incremental search.
+     */
+    enum class SearchStatus {
+        IN_PROGRESS,
+        FOUND,
+        FAILED
+    };
+
+    /**
+     * Reusable REA* search context.
+     * 
+     * The solver keeps its node storage and open list between searches, and
+     * resets them in constant time, so that the cost of a search scales with
+     * the area it explores instead of the size of the map.
+     * 
+     * Searches can also be run incrementally, a few expansions at a time, by
+     * calling `begin` and then `step` until they are no longer in progress.
+     * Their state is kept between steps, as long as the grid is.
+     * 
+     * On looping grids, sources and targets are points on the map, and the
+     * search runs on the copies of the map around the source. Paths may
+     * then cross the seams, but can't lead further than half the map away
+     * from their source, and are given back on the map.
+     * 
+     * @tparam Policy a `SearchPolicy`, choosing the heuristic, the type of
+     *         path lengths, and whether partial paths and maximum lengths are
+     *         supported.
+     */
+    template <typename Policy = DefaultPolicy>
+    class BasicREAStarSolver {
+        public:
+            BasicREAStarSolver() = default;
+
+            /**
+             * Finds the shortest path between two points on a boolean
+             * matrix.
+             * 
+             * @param source starting point.
+             * @param target goal point.
+             * @param g boolean matrix.
+             * @param maxlen maximum length of the path.
+             * @param stats if not null, receives counters for the search.
+             * 
+             * @return either a path container or nullopt if none exist.
+             */
+            std::optional<path_t> find_path(
+                const Point& source,
+                const Point& target,
+                Grid<bool>& g,
+                int maxlen = DEFAULT_PATH_MAXLEN,
+                SearchStats* stats = nullptr
+            );
+
+            /**
+             * Finds the shortest path between two points on a boolean
+             * matrix, appending it to a buffer.
+             * 
+             * @param source starting point.
+             * @param target goal point.
+             * @param g boolean matrix.
+             * @param out receives the path, after its current contents.
+             * @param maxlen maximum length of the path.
+             * @param stats if not null, receives counters for the search.
+             * 
+             * @return the number of points appended, zero if no path exists.
+             */
+            size_t find_path(
+                const Point& source,
+                const Point& target,
+                Grid<bool>& g,
+                path_t& out,
+                int maxlen = DEFAULT_PATH_MAXLEN,
+                SearchStats* stats = nullptr
+            );
+
+            /**
+             * Finds the shortest path from a point to the nearest of a set of
+             * targets on a boolean matrix, appending it to a buffer.
+             * 
+             * The search is guided by the distance to the closest target.
+             * Once it reaches one, it goes on until no interval left could
+             * lead to a closer one.
+             * 
+             * @param source starting point.
+             * @param targets goal points.
+             * @param g boolean matrix.
+             * @param out receives the path, after its current contents.
+             * @param maxlen maximum length of the path.
+             * @param stats if not null, receives counters for the search.
+             * 
+             * @return the number of points appended, zero if no path exists.
+             */
+            size_t find_path(
+                const Point& source,
+                const std::vector<Point>& targets,
+                Grid<bool>& g,
+                path_t& out,
+                int maxlen = DEFAULT_PATH_MAXLEN,
+                SearchStats* stats = nullptr
+            );
+
+            /**
+             * Starts an incremental search between two points on a boolean
+             * matrix. The matrix must outlive the search.
+             * 
+             * @param source starting point.
+             * @param target goal point.
+             * @param g boolean matrix.
+             * @param maxlen maximum length of the path.
+             * @param stats if not null, receives counters for the search.
+             */
+            void begin(
+                const Point& source,
+                const Point& target,
+                Grid<bool>& g,
+                int maxlen = DEFAULT_PATH_MAXLEN,
+                SearchStats* stats = nullptr
+            );
+
+            /**
+             * Starts an incremental search from a point to the nearest of a
+             * set of targets on a boolean matrix.
+             * 
+             * @param source starting point.
+             * @param targets goal points, at least one.
+             * @param g boolean matrix.
+             * @param maxlen maximum length of the path.
+             * @param stats if not null, receives counters for the search.
+             */
+            void begin(
+                const Point& source,
+                const std::vector<Point>& targets,
+                Grid<bool>& g,
+                int maxlen = DEFAULT_PATH_MAXLEN,
+                SearchStats* stats = nullptr
+            );
+
+            /**
+             * Continues the current search.
+             * 
+             * @param max_expansions maximum number of nodes to expand.
+             * 
+             * @return the state of the search.
+             */
+            SearchStatus step(int max_expansions);
+
+            /**
+             * Continues the current search for a given time. At least one
+             * node is expanded if the search is in progress.
+             * 
+             * @param budget time after which to stop expanding nodes.
+             * 
+             * @return the state of the search.
+             */
+            SearchStatus step_for(std::chrono::microseconds budget);
+
+            /**
+             * @return the state of the current search.
+             */
+            SearchStatus status() const { return m_status; }
+
+            /**
+             * Appends the path found by the current search to a buffer. If
+             * no target has been reached, the path leads to the closest point
+             * found so far instead.
+             * 
+             * @param out receives the path, after its current contents.
+             * 
+             * @return the number of points appended. Without partial paths,
+             *         nothing is appended until a target is reached.
+             */
+            size_t path(path_t& out) const;
+
+        private:
+            using heuristic = typename Policy::heuristic;
+            using cost_t = typename Policy::cost_t;
+            using costs = CostTraits<cost_t>;
+            using estimate_t = typename costs::estimate_t;
+            using estimates = CostTraits<estimate_t>;
+
+            /**
+             * Search state for a single cell.
+             * 
+             * The parent is stored as a cell index, with the node type (i.e.
+             * whether it was reached through an interval or is a rectangle
+             * boundary point) folded into its highest bit.
+             */
+            struct Node {
+                static constexpr uint32_t HPOINT = 0x80000000;
+
+                cost_t gvalue;
+                uint32_t link;
+
+                uint32_t parent() const { return link & ~HPOINT; }
+            };
+
+            struct SearchNode {
+                Interval interval;
+                Point min_point;
+                cost_t minfval;
+
+                bool operator<(const SearchNode& other) const {
+                    return minfval < other.minfval;
+                }
+            };
+
+            Point m_source;
+            Point m_target;
+            std::vector<Point> m_targets;
+            std::vector<Point> m_images;
+            Grid<bool>* m_g;
+            StampedGrid<Node> m_nodes;
+            cost_t m_maxlen;
+
+            /**
+             * Length of the path to `m_target` once a target has been
+             * reached. Searches for a single target stop there, while those
+             * for several go on until no interval left could lead to a
+             * closer one.
+             */
+            cost_t m_reached;
+
+            Point m_best;
+            estimate_t m_best_hval;
+
+            SearchStats* m_stats;
+            SearchStatus m_status = SearchStatus::FAILED;
+
+            /**
+             * Intervals to expand, keyed by their direction and first cell,
+             * so that an interval found again while open is updated in place.
+             */
+            IndexedHeap<SearchNode> m_open;
+
+            void start(
+                const Point& source,
+                Grid<bool>& g,
+                int maxlen,
+                SearchStats* stats
+            );
+
+            void next();
+
+            /**
+             * Ends the search once the open list runs out, or once no
+             * interval on it could lead to a closer target than the one
+             * reached.
+             */
+            void settle();
+
+            estimate_t hvalue(const Point& p) const;
+
+            /**
+             * Records a point as the closest one to the target so far, if it
+             * is, on solvers keeping partial paths.
+             */
+            void track(const Point& p) {
+                if constexpr (Policy::PARTIAL) {
+                    estimate_t h = hvalue(p);
+                    if (h < m_best_hval) {
+                        m_best = p;
+                        m_best_hval = h;
+                    }
+                }
+            }
+
+            /**
+             * @return whether a path length is under the maximum, on bounded
+             *         solvers.
+             */
+            bool within(cost_t length) const {
+                if constexpr (Policy::BOUNDED) return length < m_maxlen;
+                else return true;
+            }
+
+            /**
+             * Links the targets inside a region to the point a path enters
+             * it from, and records the closest one reached.
+             * 
+             * @return whether the search is over.
+             */
+            template <typename Region>
+            bool reaches(
+                const Region& region,
+                const Point& from,
+                cost_t gvalue
+            );
+
+            /**
+             * Records the closest target reached on an interval.
+             * 
+             * @return whether the search is over.
+             */
+            bool reaches(const Interval& interval);
+
+            void reach(const Point& target);
+
+            bool insert_start();
+            bool successor(const Interval& interval);
+            bool expand(const SearchNode& node);
+            SearchNode make_search_node(const Interval& interval) const;
+            void open(const Interval& interval);
+
+            uint32_t index(const Point& p) const {
+                return p.y * m_g->width() + p.x;
+            }
+
+            uint32_t open_key(const Interval& interval) const;
+
+            Point point(uint32_t index) const {
+                int width = m_g->width();
+                return Point { .x = int(index % width), .y = int(index / width) };
+            }
+    };
+
+    /**
+     * REA* solver for general use, with float octile lengths, partial paths
+     * and a maximum length.
+     */
+    using REAStarSolver = BasicREAStarSolver<DefaultPolicy>;
+
     /**
      * Finds the shortest path between two points on a boolean matrix.
      * 
+     * Searches share a solver per thread, so their memory is reused.
+     * 
      * @param source starting point.
      * @param target goal point.
      * @param g boolean matrix.
+     * @param maxlen maximum length of the path.
+     * @param stats if not null, receives counters for the search.
      * 
      * @return either a path container or nullopt if none exist.
      */
     std::optional<path_t> rectangle_expansion_astar(
         Point source,
         Point target,
-        const Grid<bool>& g,
-        int maxlen = DEFAULT_PATH_MAXLEN
+        Grid<bool>& g,
+        int maxlen = DEFAULT_PATH_MAXLEN,
+        SearchStats* stats = nullptr
+    );
+
+    /**
+     * Finds the shortest path between two points on a boolean matrix,
+     * writing it to a buffer instead of allocating a new one.
+     * 
+     * @param source starting point.
+     * @param target goal point.
+     * @param g boolean matrix.
+     * @param out receives the path. Its memory is reused.
+     * @param maxlen maximum length of the path.
+     * @param stats if not null, receives counters for the search.
+     * 
+     * @return the length of the path, zero if none exist.
+     */
+    size_t rectangle_expansion_astar(
+        Point source,
+        Point target,
+        Grid<bool>& g,
+        path_t& out,
+        int maxlen = DEFAULT_PATH_MAXLEN,
+        SearchStats* stats = nullptr
+    );
+
+    /**
+     * Finds the shortest path between two points on a boolean matrix,
+     * writing it to a buffer, with a solver specialized for a policy. Only
+     * `DefaultPolicy`, `CompletePolicy` and `GreedyPolicy` are compiled.
+     * 
+     * @tparam Policy search policy.
+     * 
+     * @param source starting point.
+     * @param target goal point.
+     * @param g boolean matrix.
+     * @param out receives the path. Its memory is reused.
+     * @param maxlen maximum length of the path, on bounded policies.
+     * @param stats if not null, receives counters for the search.
+     * 
+     * @return the length of the path, zero if none exist.
+     */
+    template <typename Policy>
+    size_t rectangle_expansion_astar(
+        Point source,
+        Point target,
+        Grid<bool>& g,
+        path_t& out,
+        int maxlen = DEFAULT_PATH_MAXLEN,
+        SearchStats* stats = nullptr
+    );
+
+    /**
+     * Finds the shortest path from a point to the nearest of a set of targets
+     * on a boolean matrix, writing it to a buffer.
+     * 
+     * @param source starting point.
+     * @param targets goal points.
+     * @param g boolean matrix.
+     * @param out receives the path. Its memory is reused.
+     * @param maxlen maximum length of the path.
+     * @param stats if not null, receives counters for the search.
+     * 
+     * @return the length of the path, zero if none exist. If no target can
+     *         be reached, the path leads to the closest point found instead.
+     */
+    size_t rectangle_expansion_astar_nearest(
+        Point source,
+        const std::vector<Point>& targets,
+        Grid<bool>& g,
+        path_t& out,
+        int maxlen = DEFAULT_PATH_MAXLEN,
+        SearchStats* stats = nullptr
+    );
+
+    /**
+     * Finds the shortest paths for a batch of queries on the same boolean
+     * matrix.
+     * 
+     * @param queries path queries.
+     * @param g boolean matrix.
+     * @param batch receives the paths. Its memory is reused.
+     */
+    void rectangle_expansion_astar_batch(
+        const std::vector<PathQuery>& queries,
+        Grid<bool>& g,
+        PathBatch& batch
     );
 };
@@ -0,0 +1,159 @@
+/**
+ * @file search_policy.hpp
+ * 
+ * @author Brandt
+ * @date 2020/10/18
+ * @license Zlib
+ * 
+ * Compile-time options for REA* solvers.
+ */
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+
+#include "../data/grid.hpp"
+
+namespace rea_star {
+    /**
+     * @param a first point.
+     * @param b second point.
+     * 
+     * @return the length of the shortest 8-connected path between two points
+     *         on an empty grid, with diagonal steps costing 1.414.
+     */
+    double octile(const Point& a, const Point& b);
+
+    /**
+     * Arithmetic for path lengths of a given type, along with the type
+     * heuristic estimates and distances between points are compared in.
+     * 
+     * @tparam T length type.
+     */
+    template <typename T>
+    struct CostTraits;
+
+    /**
+     * Lengths as doubles, exactly as given by `octile`.
+     */
+    template <>
+    struct CostTraits<double> {
+        using estimate_t = double;
+
+        static constexpr double UNIT = 1;
+        static constexpr double INFINITE = INFINITY;
+
+        static double octile(const Point& a, const Point& b) {
+            return ::rea_star::octile(a, b);
+        }
+    };
+
+    /**
+     * Lengths as floats, rounded from `octile`. Estimates of the length left
+     * are kept as doubles, so that ties between nodes break as they always
+     * have.
+     */
+    template <>
+    struct CostTraits<float> {
+        using estimate_t = double;
+
+        static constexpr float UNIT = 1;
+        static constexpr float INFINITE = INFINITY;
+
+        static float octile(const Point& a, const Point& b) {
+            return float(::rea_star::octile(a, b));
+        }
+    };
+
+    /**
+     * Lengths as integers, in thousandths of a step, so that diagonal steps
+     * round to the same 1.414 as float lengths. Infinity is kept well below
+     * the largest integer, so that adding a step to it can't overflow.
+     */
+    template <>
+    struct CostTraits<int32_t> {
+        using estimate_t = int32_t;
+
+        static constexpr int32_t UNIT = 1000;
+        static constexpr int32_t DIAGONAL = 1414;
+        static constexpr int32_t INFINITE = INT32_MAX / 2;
+
+        static int32_t octile(const Point& a, const Point& b) {
+            int dx = std::abs(a.x - b.x),
+                dy = std::abs(a.y - b.y);
+
+            return dx < dy
+                ? DIAGONAL * dx + UNIT * (dy - dx)
+                : DIAGONAL * dy + UNIT * (dx - dy);
+        }
+    };
+
+    /**
+     * Heuristic estimating the length left by the octile distance, which
+     * never overestimates it.
+     */
+    struct Octile {
+        template <typename T>
+        static T estimate(const Point& a, const Point& b) {
+            return CostTraits<T>::octile(a, b);
+        }
+    };
+
+    /**
+     * Heuristic estimating the length left by the Manhattan distance. It
+     * overestimates diagonal moves, so searches are greedier: they expand
+     * fewer nodes, but may find longer paths.
+     */
+    struct Manhattan {
+        template <typename T>
+        static T estimate(const Point& a, const Point& b) {
+            return CostTraits<T>::UNIT
+                * T(std::abs(a.x - b.x) + std::abs(a.y - b.y));
+        }
+    };
+
+    /**
+     * Options for an REA* solver, fixed at compile time so that the hot
+     * loops don't branch on them.
+     * 
+     * @tparam H heuristic, either `Octile` or `Manhattan`.
+     * @tparam T path length type, either `float` or `int32_t`.
+     * @tparam Partial whether to keep track of the point closest to the
+     *         target, so that failed searches still lead somewhere.
+     * @tparam Bounded whether paths are limited by a maximum length.
+     */
+    template <
+        typename H = Octile,
+        typename T = float,
+        bool Partial = true,
+        bool Bounded = true
+    >
+    struct SearchPolicy {
+        using heuristic = H;
+        using cost_t = T;
+
+        static constexpr bool PARTIAL = Partial;
+        static constexpr bool BOUNDED = Bounded;
+    };
+
+    /**
+     * Policy for general use: float octile lengths, with diagonal steps of
+     * 1.414, partial paths and a maximum length.
+     */
+    using DefaultPolicy = SearchPolicy<>;
+
+    /**
+     * Policy for searches which only want complete paths, however long. It
+     * keeps the lengths of the default policy, so that it finds the same
+     * paths: integer lengths would break ties between paths differently.
+     */
+    using CompletePolicy = SearchPolicy<Octile, float, false, false>;
+
+    /**
+     * Policy for cheap searches, which trade path quality for speed with the
+     * Manhattan heuristic on integer lengths.
+     */
+    using GreedyPolicy = SearchPolicy<Manhattan, int32_t, true, true>;
+};
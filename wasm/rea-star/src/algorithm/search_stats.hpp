@@ -0,0 +1,179 @@
+/**
+ * @file search_stats.hpp
+ * 
+ * @author Brandt
+ * @date 2020/10/17
+ * @license Zlib
+ * 
+ * Counters collected during searches.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#include "../data/grid.hpp"
+
+namespace rea_star {
+    /**
+     * Whether the detailed counters on `SearchStats` are collected, i.e.
+     * whether the module was built with `REA_STAR_STATS` defined.
+     */
+#ifdef REA_STAR_STATS
+    constexpr bool SEARCH_STATS_ENABLED = true;
+#else
+    constexpr bool SEARCH_STATS_ENABLED = false;
+#endif
+
+    /**
+     * Counters collected during a search.
+     */
+    struct SearchStats {
+        // Counters are only collected by REA* on builds with
+        // `REA_STAR_STATS` defined, and stay at zero otherwise.
+
+        /**
+         * Number of search nodes (i.e. intervals) expanded.
+         */
+        int expansions = 0;
+
+        /**
+         * Number of times an interval improved while it was already on the
+         * open list, and was updated in place instead of being queued again.
+         * Each one would otherwise have been expanded twice, unless the
+         * search ended first.
+         */
+        int merged = 0;
+
+        /**
+         * Number of intervals added to the open list.
+         */
+        int pushes = 0;
+
+        /**
+         * Largest number of intervals on the open list at once.
+         */
+        int peak_open = 0;
+
+        /**
+         * Number of lines scanned for free intervals.
+         */
+        int subinterval_scans = 0;
+
+        /**
+         * Number of cells read from the grid.
+         */
+        uint64_t probes = 0;
+
+        /**
+         * Number of cells fetched from the grid delegate.
+         */
+        uint64_t fetches = 0;
+
+        /**
+         * Time spent expanding rectangles, in microseconds.
+         */
+        double expand_us = 0;
+
+        /**
+         * Time spent generating and updating successors, in microseconds.
+         */
+        double successor_us = 0;
+
+        /**
+         * Time spent on the whole search, in microseconds.
+         */
+        double total_us = 0;
+    };
+
+    /**
+     * Distribution of searches by expansions and time, in power of two
+     * buckets.
+     */
+    struct SearchHistogram {
+        static constexpr int BUCKETS = 16;
+
+        int searches = 0;
+
+        /**
+         * Searches by expanded nodes. Bucket `i` counts searches with
+         * `2^i - 1` expansions or more, and fewer than `2^(i + 1) - 1`. The
+         * last bucket also counts every larger search.
+         */
+        int expansions[BUCKETS] = {};
+
+        /**
+         * Searches by total time. Bucket `i` counts searches which took less
+         * than `2^(i + 1)` microseconds, and at least `2^i` for `i > 0`. The
+         * last bucket also counts every slower search.
+         */
+        int latency[BUCKETS] = {};
+
+        void add(const SearchStats& stats) {
+            searches++;
+            expansions[bucket(stats.expansions + 1.0)]++;
+            latency[bucket(stats.total_us)]++;
+        }
+
+        /**
+         * @return the bucket for a value, i.e. its binary logarithm rounded
+         *         down, between zero and the last bucket.
+         */
+        static int bucket(double value) {
+            int i = 0;
+            while (i + 1 < BUCKETS && value >= double(2 << i)) i++;
+            return i;
+        }
+    };
+
+#ifdef REA_STAR_STATS
+    /**
+     * Adds the time from its construction to its destruction to a counter,
+     * if there is one.
+     */
+    class StatsTimer {
+        public:
+            explicit StatsTimer(double* counter):
+                m_counter(counter),
+                m_start(std::chrono::steady_clock::now()) {};
+
+            ~StatsTimer() {
+                if (!m_counter) return;
+
+                *m_counter += std::chrono::duration<double, std::micro>(
+                    std::chrono::steady_clock::now() - m_start
+                ).count();
+            }
+
+        private:
+            double* m_counter;
+            std::chrono::steady_clock::time_point m_start;
+    };
+
+    /**
+     * Adds the time and grid accesses on the current thread from its
+     * construction to its destruction to a search's counters, if there are
+     * any.
+     */
+    class StatsScope {
+        public:
+            explicit StatsScope(SearchStats* stats):
+                m_stats(stats),
+                m_timer(stats ? &stats->total_us : nullptr),
+                m_start(grid_counters) {};
+
+            ~StatsScope() {
+                if (!m_stats) return;
+
+                m_stats->probes += grid_counters.probes - m_start.probes;
+                m_stats->fetches += grid_counters.fetches - m_start.fetches;
+            }
+
+        private:
+            SearchStats* m_stats;
+            StatsTimer m_timer;
+            GridCounters m_start;
+    };
+#endif
+};
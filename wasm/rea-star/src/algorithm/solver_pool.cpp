@@ -0,0 +1,138 @@
+#include "solver_pool.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+using namespace rea_star;
+
+SolverPool::SolverPool(unsigned threads) {
+    for (unsigned i = 0; i < std::max(threads, 1u); i++) {
+        m_workers.push_back(std::make_unique<Worker>());
+    }
+
+    for (unsigned i = 0; i < threads; i++) {
+        m_threads.emplace_back(&SolverPool::run, this, std::ref(*m_workers[i]));
+    }
+}
+
+SolverPool::~SolverPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+
+    m_wake.notify_all();
+    for (std::thread& thread : m_threads) thread.join();
+}
+
+void SolverPool::submit(const std::vector<PathQuery>& queries, Grid<bool>& g) {
+    assert(ready());
+
+    g.load();
+
+    m_queries.assign(queries.begin(), queries.end());
+    m_g = &g;
+    m_next = 0;
+
+    if (m_threads.empty()) {
+        work(*m_workers.front());
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_running = m_threads.size();
+        m_generation++;
+    }
+
+    m_wake.notify_all();
+}
+
+bool SolverPool::ready() const {
+    return m_running.load(std::memory_order_acquire) == 0;
+}
+
+void SolverPool::collect(PathBatch& batch) {
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_done.wait(lock, [this] { return ready(); });
+    }
+
+    batch.offsets.assign(m_queries.size() + 1, 0);
+    for (const auto& worker : m_workers) {
+        for (const Result& result : worker->results) {
+            batch.offsets[result.query + 1] = result.size;
+        }
+    }
+
+    for (size_t i = 0; i < m_queries.size(); i++) {
+        batch.offsets[i + 1] += batch.offsets[i];
+    }
+
+    batch.points.resize(batch.offsets.back());
+    for (const auto& worker : m_workers) {
+        for (const Result& result : worker->results) {
+            std::copy_n(
+                worker->points.begin() + result.offset,
+                result.size,
+                batch.points.begin() + batch.offsets[result.query]
+            );
+        }
+
+        worker->results.clear();
+    }
+
+    m_queries.clear();
+    m_g = nullptr;
+}
+
+void SolverPool::run(Worker& worker) {
+    uint64_t generation = 0;
+
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [&] {
+                return m_stop || m_generation != generation;
+            });
+
+            if (m_stop) return;
+            generation = m_generation;
+        }
+
+        work(worker);
+
+        if (m_running.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_done.notify_all();
+        }
+    }
+}
+
+void SolverPool::work(Worker& worker) {
+    worker.points.clear();
+    worker.results.clear();
+
+    for (
+        size_t i = m_next.fetch_add(1, std::memory_order_relaxed);
+        i < m_queries.size();
+        i = m_next.fetch_add(1, std::memory_order_relaxed)
+    ) {
+        const PathQuery& query = m_queries[i];
+
+        size_t offset = worker.points.size();
+        size_t size = worker.solver.find_path(
+            query.source,
+            query.target,
+            *m_g,
+            worker.points,
+            query.maxlen
+        );
+
+        worker.results.push_back(Result {
+            .query = uint32_t(i),
+            .offset = uint32_t(offset),
+            .size = uint32_t(size)
+        });
+    }
+}
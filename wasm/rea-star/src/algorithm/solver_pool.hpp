@@ -0,0 +1,104 @@
+/**
+ * @file solver_pool.hpp
+ * 
+ * @author Brandt
+ * @date 2020/10/13
+ * @license Zlib
+ * 
+ * Thread pool for running batches of REA* searches concurrently.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "rea_star.hpp"
+
+namespace rea_star {
+    /**
+     * Pool of worker threads, each owning a REA* solver, which run batches
+     * of path queries on a shared grid.
+     * 
+     * Batches run in the background between `submit` and `collect`, so the
+     * caller may keep working in the meantime. Since the grid is only read
+     * during that time, it must not be modified nor destroyed until the
+     * batch is collected.
+     * 
+     * A pool without threads runs batches on the calling thread during
+     * `submit` instead.
+     */
+    class SolverPool {
+        public:
+            /**
+             * @param threads number of worker threads.
+             */
+            explicit SolverPool(unsigned threads);
+            SolverPool(const SolverPool&) = delete;
+
+            ~SolverPool();
+
+            /**
+             * Starts running a batch of queries. Any previous batch must
+             * have been collected.
+             * 
+             * Every unknown cell on the grid is fetched beforehand, so that
+             * workers never call its delegate.
+             * 
+             * @param queries path queries.
+             * @param g boolean matrix.
+             */
+            void submit(const std::vector<PathQuery>& queries, Grid<bool>& g);
+
+            /**
+             * @return whether the last batch has finished running.
+             */
+            bool ready() const;
+
+            /**
+             * Waits for the last batch to finish and gathers its paths.
+             * 
+             * @param batch receives the paths, in query order. Its memory is
+             *        reused.
+             */
+            void collect(PathBatch& batch);
+
+            unsigned threads() const { return m_threads.size(); }
+
+        private:
+            struct Result {
+                uint32_t query;
+                uint32_t offset;
+                uint32_t size;
+            };
+
+            struct Worker {
+                REAStarSolver solver;
+                path_t points;
+                std::vector<Result> results;
+            };
+
+            std::vector<std::thread> m_threads;
+            std::vector<std::unique_ptr<Worker>> m_workers;
+
+            std::vector<PathQuery> m_queries;
+            Grid<bool>* m_g = nullptr;
+
+            std::atomic<size_t> m_next { 0 };
+            std::atomic<unsigned> m_running { 0 };
+
+            std::mutex m_mutex;
+            std::condition_variable m_wake;
+            std::condition_variable m_done;
+            uint64_t m_generation = 0;
+            bool m_stop = false;
+
+            void run(Worker& worker);
+            void work(Worker& worker);
+    };
+};
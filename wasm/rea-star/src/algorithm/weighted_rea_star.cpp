@@ -0,0 +1,246 @@
+#include "weighted_rea_star.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+#include "../data/rect.hpp"
+
+using namespace rea_star;
+
+namespace rea_star {
+    /**
+     * @return the solver shared by weighted searches on the current thread.
+     */
+    WeightedREAStarSolver& weighted_solver() {
+        thread_local WeightedREAStarSolver solver;
+        return solver;
+    }
+};
+
+size_t WeightedREAStarSolver::find_path(
+    const Point& source,
+    const Point& target,
+    const Grid<uint8_t>& g,
+    path_t& out,
+    int maxcost,
+    SearchStats* stats
+) {
+    m_source = source;
+    m_target = target;
+    m_g = &g;
+    m_maxcost = maxcost;
+    m_min_cost = g.min_cost();
+    m_best = source;
+    m_best_hval = hvalue(source);
+    m_stats = stats;
+
+    m_nodes.reset(g.width(), g.height(), Node {
+        .gvalue = INFINITY,
+        .link = index(source)
+    });
+
+    m_open.reset(size_t(g.width()) * g.height() * std::size(CARDINALS));
+
+    // The heuristic underestimates costs away from the cheapest cells, so
+    // reaching the target is not enough to stop: the search goes on until
+    // no interval on the open list could lead to a cheaper path.
+    insert_start();
+    while (
+        !m_open.empty()
+        && m_open.priority(m_open.top()).minfval < m_nodes[m_target].gvalue
+    ) {
+        Interval interval = m_open.priority(m_open.top()).interval;
+        m_open.pop();
+
+        expand(interval);
+    }
+
+    bool found = m_nodes[m_target].gvalue < INFINITY;
+
+    size_t start = out.size();
+
+    for (Point current = found ? m_target : m_best; current != m_source;) {
+        out.push_back(current);
+        current = point(m_nodes[current].link);
+    }
+
+    out.push_back(m_source);
+
+    std::reverse(out.begin() + start, out.end());
+    return out.size() - start;
+}
+
+void WeightedREAStarSolver::insert_start() {
+    auto rect = Rect::expand_point(m_source, *m_g);
+    float cost = (*m_g)[m_source];
+
+    if (rect.contains(m_target)) {
+        m_nodes[m_target] = Node {
+            .gvalue = cost * float(octile(m_target, m_source)),
+            .link = index(m_source)
+        };
+    }
+
+    rect.for_each_boundary([&](const Point& p) {
+        m_nodes[p] = Node {
+            .gvalue = cost * float(octile(p, m_source)),
+            .link = index(m_source)
+        };
+    });
+
+    for (Cardinal cardinal : CARDINALS) {
+        auto interval = rect.extend_neighbor_interval(cardinal);
+        if (interval.is_valid(*m_g)) successor(interval);
+    }
+}
+
+void WeightedREAStarSolver::successor(const Interval& interval) {
+    interval.for_each_uniform_subinterval(
+        *m_g,
+        [&](const Interval& fsi) {
+            float cost = (*m_g)[fsi.at(0)];
+            bool updated = false;
+
+            // Runs end where costs change as well as on blocked cells, so
+            // cells on their ends can also be entered diagonally from the
+            // parent line just past them, as long as either orthogonal
+            // route around the corner is free.
+            Interval parent = Interval(
+                fsi.cardinal(),
+                fsi.parent().fixed(),
+                std::max(fsi.min() - 1, 0),
+                std::min(fsi.max() + 1, length(fsi.axis()) - 1)
+            );
+
+            for (int i = 0; i < fsi.length(); i++) {
+                Point p = fsi.at(i);
+                int k = fsi.min() + i - parent.min();
+
+                for (int j = k - 1; j <= k + 1; j++) {
+                    if (j < 0 || j >= parent.length()) continue;
+
+                    Point pp = parent.at(j);
+                    if (
+                        j != k
+                        && (*m_g)[Point { .x = p.x, .y = pp.y }] == 0
+                        && (*m_g)[Point { .x = pp.x, .y = p.y }] == 0
+                    ) continue;
+
+                    updated |= relax(p, pp, cost);
+                }
+            }
+
+            if (updated) open(fsi);
+            return false;
+        }
+    );
+}
+
+void WeightedREAStarSolver::expand(const Interval& interval) {
+#ifdef REA_STAR_STATS
+    if (m_stats) m_stats->expansions++;
+#endif
+
+    auto rect = Rect::expand_interval(interval, *m_g);
+    float cost = (*m_g)[interval.at(0)];
+
+    if (rect.contains(m_target)) {
+        for (const Point& pp : interval) relax(m_target, pp, cost);
+    }
+
+    for (const Interval& wall : rect.walls(interval.cardinal())) {
+        for (const Point& p : wall) {
+            for (const Point& pp : interval) relax(p, pp, cost);
+        }
+
+        auto eni = rect.extend_neighbor_interval(wall.cardinal());
+        if (eni.is_valid(*m_g)) successor(eni);
+    }
+}
+
+bool WeightedREAStarSolver::relax(
+    const Point& p,
+    const Point& pp,
+    float cost
+) {
+    float pgvalue = m_nodes[pp].gvalue + cost * float(octile(p, pp));
+
+    Node& node = m_nodes[p];
+    if (pgvalue >= node.gvalue || pgvalue >= m_maxcost) return false;
+
+    double h = hvalue(p);
+    if (h < m_best_hval) {
+        m_best = p;
+        m_best_hval = h;
+    }
+
+    node = Node { .gvalue = pgvalue, .link = index(pp) };
+    return true;
+}
+
+double WeightedREAStarSolver::hvalue(const Point& p) const {
+    return m_min_cost * octile(p, m_target);
+}
+
+WeightedREAStarSolver::SearchNode WeightedREAStarSolver::make_search_node(
+    const Interval& interval
+) const {
+    float minfval = INFINITY;
+    for (const Point& p : interval) {
+        minfval = std::min(minfval, float(m_nodes[p].gvalue + hvalue(p)));
+    }
+
+    return SearchNode { .interval = interval, .minfval = minfval };
+}
+
+void WeightedREAStarSolver::open(const Interval& interval) {
+    uint32_t key = open_key(interval);
+    if (!m_open.contains(key)) {
+        m_open.push(key, make_search_node(interval));
+        return;
+    }
+
+    // Runs starting on the same cell and going the same way have the same
+    // cost and only differ on their ends, so the longest one covers both.
+    const Interval& queued = m_open.priority(key).interval;
+    const Interval& longest = queued.max() > interval.max() ? queued : interval;
+
+    m_open.update(key, make_search_node(longest));
+
+#ifdef REA_STAR_STATS
+    if (m_stats) m_stats->merged++;
+#endif
+}
+
+uint32_t WeightedREAStarSolver::open_key(const Interval& interval) const {
+    uint32_t direction = 0;
+    switch (interval.cardinal()) {
+    case Cardinal::NORTH: direction = 0; break;
+    case Cardinal::SOUTH: direction = 1; break;
+    case Cardinal::EAST: direction = 2; break;
+    case Cardinal::WEST: direction = 3; break;
+    }
+
+    uint32_t cells = m_g->width() * m_g->height();
+    return direction * cells + index(interval.at(0));
+}
+
+size_t rea_star::weighted_rectangle_expansion_astar(
+    Point source,
+    Point target,
+    const Grid<uint8_t>& g,
+    path_t& out,
+    int maxcost,
+    SearchStats* stats
+) {
+    out.clear();
+    return weighted_solver().find_path(
+        source,
+        target,
+        g,
+        out,
+        maxcost,
+        stats
+    );
+}
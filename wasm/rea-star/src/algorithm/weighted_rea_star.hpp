@@ -0,0 +1,156 @@
+/**
+ * @file weighted_rea_star.hpp
+ * 
+ * @author Brandt
+ * @date 2020/10/18
+ * @license Zlib
+ * 
+ * REA* over grids with movement costs.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "rea_star.hpp"
+
+#include "../data/cost_grid.hpp"
+#include "../data/indexed_heap.hpp"
+#include "../data/interval.hpp"
+#include "../data/stamped_grid.hpp"
+
+namespace rea_star {
+    /**
+     * Reusable REA* search context for cost grids.
+     * 
+     * Moving into a cell costs the distance moved times the cost of the cell.
+     * Rectangles are only expanded over cells sharing the same cost, so that
+     * the cost between any two points inside one is still their octile
+     * distance scaled by it, and cost changes split intervals just like
+     * blocked cells do. Cells on the ends of an interval can also be entered
+     * diagonally from past its ends, which matters on grids where intervals
+     * are cut short by costs changing.
+     * 
+     * The heuristic is the octile distance scaled by the lowest cost on the
+     * grid, which underestimates the cost of crossing pricier cells. The
+     * search doesn't stop when it reaches the target, but once no interval
+     * left on the open list could lead to a cheaper path.
+     * 
+     * Paths are not guaranteed to be the cheapest ones. Like REA*, the
+     * search only links points on the edges of the rectangles it expands,
+     * which can miss slightly cheaper routes.
+     */
+    class WeightedREAStarSolver {
+        public:
+            WeightedREAStarSolver() = default;
+
+            /**
+             * Finds a cheap path between two points on a cost grid,
+             * appending it to a buffer. It may cost slightly more than the
+             * cheapest one.
+             * 
+             * @param source starting point.
+             * @param target goal point.
+             * @param g cost grid.
+             * @param out receives the path, after its current contents. If
+             *        the target can't be reached, it receives the path to the
+             *        closest point found instead.
+             * @param maxcost maximum cost of the path.
+             * @param stats if not null, receives counters for the search.
+             * 
+             * @return the number of points appended.
+             */
+            size_t find_path(
+                const Point& source,
+                const Point& target,
+                const Grid<uint8_t>& g,
+                path_t& out,
+                int maxcost = DEFAULT_PATH_MAXLEN,
+                SearchStats* stats = nullptr
+            );
+
+        private:
+            /**
+             * Search state for a single cell, with the parent stored as a
+             * cell index.
+             */
+            struct Node {
+                float gvalue;
+                uint32_t link;
+            };
+
+            struct SearchNode {
+                Interval interval;
+                float minfval;
+
+                bool operator<(const SearchNode& other) const {
+                    return minfval < other.minfval;
+                }
+            };
+
+            Point m_source;
+            Point m_target;
+            const Grid<uint8_t>* m_g;
+            StampedGrid<Node> m_nodes;
+            int m_maxcost;
+            int m_min_cost;
+
+            Point m_best;
+            double m_best_hval;
+
+            SearchStats* m_stats;
+
+            /**
+             * Intervals to expand, keyed by their direction and first cell.
+             */
+            IndexedHeap<SearchNode> m_open;
+
+            double hvalue(const Point& p) const;
+
+            void insert_start();
+            void successor(const Interval& interval);
+            void expand(const Interval& interval);
+            bool relax(const Point& p, const Point& pp, float cost);
+            SearchNode make_search_node(const Interval& interval) const;
+            void open(const Interval& interval);
+
+            uint32_t index(const Point& p) const {
+                return p.y * m_g->width() + p.x;
+            }
+
+            uint32_t open_key(const Interval& interval) const;
+
+            int length(Axis axis) const {
+                return axis == Axis::X ? m_g->height() : m_g->width();
+            }
+
+            Point point(uint32_t index) const {
+                int width = m_g->width();
+                return Point { .x = int(index % width), .y = int(index / width) };
+            }
+    };
+
+    /**
+     * Finds a cheap path between two points on a cost grid, with a
+     * solver shared by searches on the current thread.
+     * 
+     * @param source starting point.
+     * @param target goal point.
+     * @param g cost grid.
+     * @param out receives the path, replacing its contents.
+     * @param maxcost maximum cost of the path.
+     * @param stats if not null, receives counters for the search.
+     * 
+     * @return the number of points on the path. If the target can't be
+     *         reached, the path leads to the closest point found instead.
+     */
+    size_t weighted_rectangle_expansion_astar(
+        Point source,
+        Point target,
+        const Grid<uint8_t>& g,
+        path_t& out,
+        int maxcost = DEFAULT_PATH_MAXLEN,
+        SearchStats* stats = nullptr
+    );
+};
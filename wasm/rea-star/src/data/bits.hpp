@@ -0,0 +1,178 @@
+/**
+ * @file bits.hpp
+ * 
+ * @author Brandt
+ * @date 2020/10/10
+ * @license Zlib
+ * 
+ * Word-parallel scanning of packed bit arrays.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#if defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace rea_star::bits {
+    using word_t = uint64_t;
+
+    constexpr int WORD_BITS = 64;
+
+    constexpr word_t ONES = ~word_t(0);
+
+    /**
+     * @param n number of bits.
+     * 
+     * @return number of words needed to store that many bits.
+     */
+    inline constexpr int words(int n) {
+        return (n + WORD_BITS - 1) / WORD_BITS;
+    }
+
+    /**
+     * @param i bit index.
+     * 
+     * @return mask for the bit inside its word.
+     */
+    [[gnu::always_inline]]
+    inline constexpr word_t bit(int i) {
+        return word_t(1) << (i % WORD_BITS);
+    }
+
+    /**
+     * @param i bit index.
+     * 
+     * @return mask for the bits from i to the end of its word.
+     */
+    [[gnu::always_inline]]
+    inline constexpr word_t from(int i) {
+        return ONES << (i % WORD_BITS);
+    }
+
+    /**
+     * @param i bit index.
+     * 
+     * @return mask for the bits from the start of its word up to i.
+     */
+    [[gnu::always_inline]]
+    inline constexpr word_t upto(int i) {
+        return ONES >> (WORD_BITS - 1 - i % WORD_BITS);
+    }
+
+    /**
+     * Finds the first word in a range which differs from a given value.
+     * 
+     * Compares two words at a time with SIMD when available, since long runs
+     * of fully free or fully blocked words are the common case on maps.
+     * 
+     * @param words packed bits.
+     * @param begin first word index.
+     * @param end word index past the end of the range.
+     * @param value value to skip.
+     * 
+     * @return index of the first word different from value, or end if none.
+     */
+    [[gnu::hot]]
+    inline int skip(const word_t* words, int begin, int end, word_t value) {
+        int i = begin;
+
+#if defined(__wasm_simd128__)
+        v128_t v = wasm_i64x2_splat(value);
+        for (; i + 2 <= end; i += 2) {
+            v128_t w = wasm_v128_load(words + i);
+            if (!wasm_i8x16_all_true(wasm_i8x16_eq(w, v))) break;
+        }
+#elif defined(__SSE2__)
+        __m128i v = _mm_set1_epi64x(static_cast<long long>(value));
+        for (; i + 2 <= end; i += 2) {
+            __m128i w = _mm_loadu_si128(
+                reinterpret_cast<const __m128i*>(words + i));
+
+            if (_mm_movemask_epi8(_mm_cmpeq_epi8(w, v)) != 0xffff) break;
+        }
+#endif
+
+        while (i < end && words[i] == value) i++;
+        return i;
+    }
+
+    /**
+     * Finds the first bit with a given value on a range.
+     * 
+     * @tparam Value value to look for.
+     * 
+     * @param words packed bits.
+     * @param first first bit index.
+     * @param last last bit index (inclusive).
+     * 
+     * @return index of the first matching bit, or last + 1 if none.
+     */
+    template <bool Value>
+    [[gnu::hot]]
+    inline int find(const word_t* words, int first, int last) {
+        if (first > last) return last + 1;
+
+        constexpr word_t flip = Value ? 0 : ONES;
+
+        int w = first / WORD_BITS,
+            end = last / WORD_BITS;
+
+        word_t current = (words[w] ^ flip) & from(first);
+        if (current == 0 && w < end) {
+            w = skip(words, w + 1, end, flip);
+            current = words[w] ^ flip;
+        }
+
+        if (current == 0) return last + 1;
+
+        int i = w * WORD_BITS + __builtin_ctzll(current);
+        return i <= last ? i : last + 1;
+    }
+
+    /**
+     * Finds the last bit with a given value on a range.
+     * 
+     * @tparam Value value to look for.
+     * 
+     * @param words packed bits.
+     * @param first first bit index.
+     * @param last last bit index (inclusive).
+     * 
+     * @return index of the last matching bit, or first - 1 if none.
+     */
+    template <bool Value>
+    [[gnu::hot]]
+    inline int rfind(const word_t* words, int first, int last) {
+        if (first > last) return first - 1;
+
+        constexpr word_t flip = Value ? 0 : ONES;
+
+        int w = last / WORD_BITS,
+            begin = first / WORD_BITS;
+
+        word_t current = (words[w] ^ flip) & upto(last);
+        while (current == 0 && w > begin) current = words[--w] ^ flip;
+
+        if (current == 0) return first - 1;
+
+        int i = w * WORD_BITS + (WORD_BITS - 1 - __builtin_clzll(current));
+        return i >= first ? i : first - 1;
+    }
+
+    /**
+     * @param words packed bits.
+     * @param first first bit index.
+     * @param last last bit index (inclusive).
+     * 
+     * @return whether all bits on the range are set.
+     */
+    [[gnu::hot]]
+    inline bool all(const word_t* words, int first, int last) {
+        return find<false>(words, first, last) > last;
+    }
+};
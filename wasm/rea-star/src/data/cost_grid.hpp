@@ -0,0 +1,222 @@
+/**
+ * @file cost_grid.hpp
+ * 
+ * @author Brandt
+ * @date 2020/10/18
+ * @license Zlib
+ * 
+ * Weighted grid map data type.
+ */
+
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+#include "cardinal.hpp"
+#include "grid.hpp"
+
+namespace rea_star {
+    /**
+     * Cost grid, where each cell holds the cost of moving into it, from 1 to
+     * 255, or zero if it is blocked.
+     * 
+     * Cells are stored both by rows and by columns, so that runs of cells
+     * with the same cost can be scanned contiguously in either direction.
+     * Cells outside the grid are considered blocked.
+     */
+    template <>
+    class Grid<uint8_t> {
+        public:
+            Grid(const Grid&) = default;
+            Grid(Grid&&) = default;
+
+            Grid& operator=(const Grid&) = default;
+            Grid& operator=(Grid&&) = default;
+
+            /**
+             * @param width grid width.
+             * @param height grid height.
+             * @param data row-major buffer with the cost of each cell.
+             */
+            Grid(int width, int height, const std::vector<uint8_t>& data):
+                m_width(width),
+                m_height(height),
+                m_rows(data),
+                m_cols(data.size()) {
+                assert(data.size() == static_cast<size_t>(width * height));
+
+                for (int y = 0; y < m_height; y++) {
+                    for (int x = 0; x < m_width; x++) {
+                        uint8_t cost = data[x + y * m_width];
+
+                        m_cols[y + x * m_height] = cost;
+                        m_counts[cost]++;
+                    }
+                }
+            };
+
+            [[gnu::hot]]
+            uint8_t operator[](const Point& p) const {
+                assert(p.x >= 0);
+                assert(p.y >= 0);
+                assert(p.x < m_width);
+                assert(p.y < m_height);
+
+                return m_rows[p.y * m_width + p.x];
+            }
+
+            /**
+             * Overwrites the cost of a single cell.
+             * 
+             * @param p cell position.
+             * @param cost cost of moving into the cell, zero if blocked.
+             */
+            void set(const Point& p, uint8_t cost) {
+                assert(p.x >= 0);
+                assert(p.y >= 0);
+                assert(p.x < m_width);
+                assert(p.y < m_height);
+
+                uint8_t& cell = m_rows[p.y * m_width + p.x];
+                m_counts[cell]--;
+                m_counts[cost]++;
+
+                cell = cost;
+                m_cols[p.y + p.x * m_height] = cost;
+            }
+
+            /**
+             * @return the lowest cost of a free cell, or zero if every cell
+             *         is blocked. Distances scaled by it never overestimate
+             *         the cost of a path.
+             */
+            int min_cost() const {
+                for (int cost = 1; cost < COSTS; cost++) {
+                    if (m_counts[cost] > 0) return cost;
+                }
+
+                return 0;
+            }
+
+            /**
+             * @param axis axis of the fixed coordinate.
+             * @param fixed fixed coordinate of the line.
+             * @param min first cell on the line.
+             * @param max last cell on the line (inclusive).
+             * @param cost expected cost.
+             * 
+             * @return whether all cells on the line segment have a given
+             *         cost.
+             */
+            [[gnu::hot]]
+            bool all_equal(
+                Axis axis,
+                int fixed,
+                int min,
+                int max,
+                uint8_t cost
+            ) const {
+                if (fixed < 0 || fixed >= lines(axis)) return false;
+                if (min < 0 || max >= length(axis)) return false;
+
+                const uint8_t* cells = line(axis, fixed);
+                for (int i = min; i <= max; i++) {
+                    if (cells[i] != cost) return false;
+                }
+
+                return true;
+            }
+
+            /**
+             * @param axis axis of the fixed coordinate.
+             * @param fixed fixed coordinate of the line, inside the grid.
+             * @param min first cell on the line, inside the grid.
+             * @param max last cell on the line (inclusive), inside the grid.
+             * 
+             * @return the first free cell on the line segment, or max + 1 if
+             *         there is none.
+             */
+            [[gnu::hot]]
+            int find_free(Axis axis, int fixed, int min, int max) const {
+                const uint8_t* cells = line(axis, fixed);
+
+                int i = min;
+                while (i <= max && cells[i] == 0) i++;
+                return i;
+            }
+
+            /**
+             * @param axis axis of the fixed coordinate.
+             * @param fixed fixed coordinate of the line, inside the grid.
+             * @param min first cell on the line, inside the grid.
+             * @param max last cell on the line (inclusive), inside the grid.
+             * 
+             * @return the first cell on the line segment with a different
+             *         cost than the one at min, or max + 1 if there is none.
+             */
+            [[gnu::hot]]
+            int find_change(Axis axis, int fixed, int min, int max) const {
+                const uint8_t* cells = line(axis, fixed);
+
+                int i = min;
+                while (i <= max && cells[i] == cells[min]) i++;
+                return i;
+            }
+
+            /**
+             * @param axis axis of the fixed coordinate.
+             * @param fixed fixed coordinate of the line, inside the grid.
+             * @param min first cell on the line, inside the grid.
+             * @param max last cell on the line (inclusive), inside the grid.
+             * 
+             * @return the last cell on the line segment with a different
+             *         cost than the one at max, or min - 1 if there is none.
+             */
+            [[gnu::hot]]
+            int rfind_change(Axis axis, int fixed, int min, int max) const {
+                const uint8_t* cells = line(axis, fixed);
+
+                int i = max;
+                while (i >= min && cells[i] == cells[max]) i--;
+                return i;
+            }
+
+            int width() const { return m_width; }
+            int height() const { return m_height; }
+
+        private:
+            static constexpr int COSTS = 256;
+
+            int m_width;
+            int m_height;
+
+            std::vector<uint8_t> m_rows;
+            std::vector<uint8_t> m_cols;
+
+            /**
+             * Number of cells with each cost.
+             */
+            int m_counts[COSTS] = {};
+
+            int lines(Axis axis) const {
+                return axis == Axis::X ? m_width : m_height;
+            }
+
+            int length(Axis axis) const {
+                return axis == Axis::X ? m_height : m_width;
+            }
+
+            const uint8_t* line(Axis axis, int fixed) const {
+                return axis == Axis::X
+                    ? m_cols.data() + fixed * m_height
+                    : m_rows.data() + fixed * m_width;
+            }
+    };
+
+    /**
+     * Grid of movement costs, for weighted searches.
+     */
+    using CostGrid = Grid<uint8_t>;
+};
@@ -10,12 +10,44 @@
 
 #pragma once
 
-#include <emscripten/bind.h>
-
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <cstdint>
+#include <functional>
 #include <vector>
 
+#include "bits.hpp"
+#include "cardinal.hpp"
+
+#ifdef REA_STAR_STATS
+#define REA_STAR_GRID_COUNT(counter, n) \
+    (::rea_star::grid_counters.counter += (n))
+#else
+#define REA_STAR_GRID_COUNT(counter, n) ((void) 0)
+#endif
+
 namespace rea_star {
+#ifdef REA_STAR_STATS
+    /**
+     * Accesses to boolean grids made on a thread, only counted on builds
+     * with `REA_STAR_STATS` defined.
+     */
+    struct GridCounters {
+        /**
+         * Cells read, including the whole segment of every line scan.
+         */
+        uint64_t probes = 0;
+
+        /**
+         * Cells fetched from a delegate, i.e. calls into JavaScript.
+         */
+        uint64_t fetches = 0;
+    };
+
+    inline thread_local GridCounters grid_counters;
+#endif
+
     struct Point {
         int x;
         int y;
@@ -29,6 +61,14 @@ namespace rea_star {
         return a.x != b.x || a.y != b.y;
     }
 
+    /**
+     * Axes along which a map wraps around, like RPG Maker's looping maps.
+     */
+    struct Topology {
+        bool loop_x = false;
+        bool loop_y = false;
+    };
+
     template <typename T>
     class Grid {
         public:
@@ -80,43 +120,1123 @@ namespace rea_star {
             std::vector<T> m_data;
     };
 
+    /**
+     * Boolean grid, where true means free and false means blocked.
+     * 
+     * Cells are packed into bits both by rows and by columns, so that runs of
+     * free or blocked cells can be scanned a word at a time in either
+     * direction. Cells outside the grid are considered blocked.
+     * 
+     * Free cells may also have walls, blocking movement through some of
+     * their edges, like RPG Maker's directional passage flags. Edges are
+     * walled when either of the cells next to them blocks them, and are
+     * packed the same way as cells. Line scans treat walls along a line as
+     * splitting it, and sweeps stop at walls across their way. Plain cell
+     * reads, meant for searches unaware of walls, see cells with any of
+     * them as blocked.
+     * 
+     * Grids for looping maps hold two copies of the map along each axis it
+     * loops on, side by side, so that searches can run across the seam on a
+     * window around their source without any line scan having to wrap
+     * around. Cells on every copy are always kept the same, and points given
+     * to writes are on the map, i.e. on the first copy.
+     */
     template <>
     class Grid<bool> {
         public:
             Grid(const Grid&) = default;
             Grid(Grid&&) = default;
 
-            Grid(emscripten::val map):
-                m_width(map["width"].as<int>()),
-                m_height(map["height"].as<int>()),
-                m_delegate(map["color"].call<emscripten::val>("bind", map)),
-                m_mask(m_width * m_height, false),
-                m_cache(m_width * m_height) {};
+            Grid& operator=(const Grid&) = default;
+            Grid& operator=(Grid&&) = default;
+
+            /**
+             * Region changed by a write to the grid, along with the version
+             * the write gave the grid.
+             */
+            struct Change {
+                uint32_t version;
+                int left;
+                int top;
+                int right;
+                int bottom;
+
+                /**
+                 * @return whether the region overlaps a rectangle.
+                 */
+                bool overlaps(int l, int t, int r, int b) const {
+                    return left <= r && right >= l && top <= b && bottom >= t;
+                }
+            };
+
+            /**
+             * Number of writes whose regions are kept on the change journal.
+             */
+            static constexpr size_t JOURNAL_SIZE = 64;
+
+            /**
+             * Function mapping points to their passability.
+             */
+            using delegate_t = std::function<bool(const Point&)>;
+
+            /**
+             * Function mapping points to their walls, as a mask of the
+             * directions they block.
+             */
+            using walls_delegate_t = std::function<int(const Point&)>;
+
+            /**
+             * @param cardinal direction.
+             * 
+             * @return the bit on a wall mask blocking a direction, matching
+             *         RPG Maker's passage flags.
+             */
+            static constexpr int wall(Cardinal cardinal) {
+                switch (cardinal) {
+                case Cardinal::SOUTH: return 0x1;
+                case Cardinal::WEST: return 0x2;
+                case Cardinal::EAST: return 0x4;
+                case Cardinal::NORTH: return 0x8;
+                }
 
-            [[gnu::hot, gnu::pure]]
+                return 0;
+            }
+
+            /**
+             * Lazy grid, fetching each cell from a delegate the first time it
+             * is accessed.
+             * 
+             * @param width grid width.
+             * @param height grid height.
+             * @param delegate function mapping points to passability.
+             * @param walls function mapping points to their walls, if any.
+             * @param topology axes the map loops on.
+             */
+            Grid(
+                int width,
+                int height,
+                delegate_t delegate,
+                walls_delegate_t walls = nullptr,
+                Topology topology = {}
+            ):
+                m_width(topology.loop_x ? 2 * width : width),
+                m_height(topology.loop_y ? 2 * height : height),
+                m_map_width(width),
+                m_map_height(height),
+                m_topology(topology),
+                m_row_words(bits::words(m_width)),
+                m_col_words(bits::words(m_height)),
+                m_unknown(m_width * m_height),
+                m_delegate(std::move(delegate)),
+                m_walls_delegate(std::move(walls)),
+                m_rows(m_row_words * m_height, 0),
+                m_cols(m_col_words * m_width, 0),
+                m_known_rows(m_row_words * m_height, 0),
+                m_known_cols(m_col_words * m_width, 0) {};
+
+            /**
+             * Preloaded grid, taking the whole passability map at once as a
+             * row-major buffer with one byte per cell: its lowest bit set if
+             * the cell is free, and its walls on the next four bits. Blocked
+             * cells keep their walls for when they are set free.
+             * 
+             * The delegates, if given, are only used to refetch cells after
+             * they are invalidated.
+             * 
+             * @param width grid width.
+             * @param height grid height.
+             * @param data passability buffer.
+             * @param delegate function mapping points to passability.
+             * @param walls function mapping points to their walls.
+             * @param topology axes the map loops on.
+             */
+            Grid(
+                int width,
+                int height,
+                const std::vector<uint8_t>& data,
+                delegate_t delegate = nullptr,
+                walls_delegate_t walls = nullptr,
+                Topology topology = {}
+            ): Grid(
+                width,
+                height,
+                std::move(delegate),
+                std::move(walls),
+                topology
+            ) {
+                assert(data.size() == static_cast<size_t>(width * height));
+
+                for (int y = 0; y < m_height; y++) {
+                    for (int x = 0; x < m_width; x++) {
+                        uint8_t cell = data[
+                            x % m_map_width + y % m_map_height * m_map_width
+                        ];
+
+                        store(x, y, cell & 1);
+                        store_walls(x, y, (cell >> 1) & 0xf);
+                        know(x, y);
+                    }
+                }
+
+                m_unknown = 0;
+            };
+
+            /**
+             * @return whether a cell is free and has no walls, i.e. whether
+             *         it can be moved through in any direction.
+             */
+            [[gnu::hot]]
             bool operator[](const Point& p) {
                 assert(p.x >= 0);
                 assert(p.y >= 0);
                 assert(p.x < m_width);
                 assert(p.y < m_height);
 
-                int i = p.x + p.y * m_width;
-                if (m_mask[i]) return m_cache[i];
+                REA_STAR_GRID_COUNT(probes, 1);
+
+                require(p.x, p.y);
+                return free(p.x, p.y) && !walled(p.x, p.y);
+            }
+
+            /**
+             * @return whether a cell is free, regardless of its walls.
+             */
+            [[gnu::hot]]
+            bool enterable(const Point& p) {
+                assert(p.x >= 0);
+                assert(p.y >= 0);
+                assert(p.x < m_width);
+                assert(p.y < m_height);
+
+                REA_STAR_GRID_COUNT(probes, 1);
+
+                require(p.x, p.y);
+                return free(p.x, p.y);
+            }
+
+            /**
+             * @return the walls of a cell, as a mask of `wall` bits.
+             */
+            int walls(const Point& p) {
+                assert(p.x >= 0);
+                assert(p.y >= 0);
+                assert(p.x < m_width);
+                assert(p.y < m_height);
+
+                require(p.x, p.y);
+                return has_walls() ? m_walls[p.x + p.y * m_width] : 0;
+            }
+
+            /**
+             * Overwrites the walls of a single cell. The version only changes
+             * if the walls do.
+             * 
+             * @param p cell position.
+             * @param mask mask of `wall` bits for the directions the cell
+             *        can't be left or entered through.
+             */
+            void set_walls(const Point& p, int mask) {
+                assert(p.x >= 0);
+                assert(p.y >= 0);
+                assert(p.x < m_map_width);
+                assert(p.y < m_map_height);
+
+                require(p.x, p.y);
+                if (walls(p) == (mask & 0xf)) return;
+
+                for_each_image(p, [&](const Point& q) {
+                    store_walls(q.x, q.y, mask & 0xf);
+
+                    // Walls on a cell also wall the edges it shares with the
+                    // cells before it on its row and column.
+                    if (has_clearance()) {
+                        dirty(
+                            std::max(q.x - 1, 0),
+                            std::max(q.y - 1, 0),
+                            q.x,
+                            q.y
+                        );
+                    }
+                });
+
+                record(p.x, p.y, p.x, p.y);
+            }
+
+            /**
+             * @return whether any cell on the grid has ever had walls.
+             */
+            bool has_walls() const { return !m_walls.empty(); }
+
+            /**
+             * Checks whether the walls between two neighboring cells allow
+             * moving from one into the other. Like on RPG Maker, diagonal
+             * moves need either of the two orthogonal routes between the
+             * cells to be open, through a free cell. On grids without walls,
+             * every move is open.
+             * 
+             * @param a cell position, inside the grid.
+             * @param b position of a neighbor of the cell, inside the grid.
+             * 
+             * @return whether the move is open.
+             */
+            [[gnu::hot]]
+            bool passable(const Point& a, const Point& b) {
+                if (m_unknown > 0) {
+                    require(a.x, a.y);
+                    require(b.x, b.y);
+                    require(a.x, b.y);
+                    require(b.x, a.y);
+                }
+
+                if (!has_walls()) return true;
+
+                int x = std::min(a.x, b.x),
+                    y = std::min(a.y, b.y);
+
+                if (a.y == b.y) return open_h(x, y);
+                if (a.x == b.x) return open_v(x, y);
+
+                return (free(b.x, a.y) && open_h(x, a.y) && open_v(b.x, y))
+                    || (free(a.x, b.y) && open_v(a.x, y) && open_h(x, b.y));
+            }
+
+            /**
+             * Overwrites the passability of a single cell. The version only
+             * changes if the cell does, so that setting cells to what they
+             * already are keeps everything derived from the grid.
+             * 
+             * @param p cell position.
+             * @param value whether the cell is free.
+             */
+            void set(const Point& p, bool value) {
+                assert(p.x >= 0);
+                assert(p.y >= 0);
+                assert(p.x < m_map_width);
+                assert(p.y < m_map_height);
+
+                bool changed = false;
+                for_each_image(p, [&](const Point& q) {
+                    if (!known(q.x, q.y)) {
+                        know(q.x, q.y);
+                        m_unknown--;
+                    } else if (free(q.x, q.y) == value) {
+                        return;
+                    }
+
+                    changed = true;
+                    store(q.x, q.y, value);
+                    if (has_clearance()) dirty(q.x, q.y, q.x, q.y);
+                });
+
+                if (changed) record(p.x, p.y, p.x, p.y);
+            }
+
+            /**
+             * Drops the known passability of every cell in a rectangular
+             * region, so that they are fetched again from the delegate on
+             * their next access. Parts of the region outside of the grid are
+             * ignored.
+             * 
+             * @param left leftmost column of the region.
+             * @param top topmost row of the region.
+             * @param right rightmost column of the region.
+             * @param bottom bottommost row of the region.
+             */
+            void invalidate(int left, int top, int right, int bottom) {
+                assert(m_delegate);
+
+                left = std::max(left, 0);
+                top = std::max(top, 0);
+                right = std::min(right, m_map_width - 1);
+                bottom = std::min(bottom, m_map_height - 1);
+                if (left > right || top > bottom) return;
+
+                Point corner = { .x = left, .y = top };
+                for_each_image(corner, [&](const Point& q) {
+                    int dx = q.x - left,
+                        dy = q.y - top;
+
+                    forget(left + dx, top + dy, right + dx, bottom + dy);
+                });
+
+                record(left, top, right, bottom);
+            }
+
+            /**
+             * @return a number which changes whenever cells change or are
+             *         invalidated, so that data derived from the grid can tell
+             *         it is stale. Versions are never shared between grids,
+             *         so a grid allocated where another one was freed can't
+             *         be mistaken for it.
+             */
+            uint32_t version() const { return m_version; }
+
+            /**
+             * Calls a function on every region changed since a version of
+             * the grid, once for each copy of the region on looping grids.
+             * Only the last `JOURNAL_SIZE` writes are kept.
+             * 
+             * @param version earlier version of the grid.
+             * @param f function taking each change, in grid coordinates.
+             * 
+             * @return whether every change since the version is known. If
+             *         not, none are reported, and anything derived from the
+             *         grid at that version must be thrown away.
+             */
+            template <typename F>
+            bool for_each_change(uint32_t version, F f) const {
+                if (version < m_forgotten) return false;
+
+                for (const Change& change : m_changes) {
+                    if (change.version <= version) continue;
+
+                    Point corner = { .x = change.left, .y = change.top };
+                    for_each_image(corner, [&](const Point& q) {
+                        int dx = q.x - change.left,
+                            dy = q.y - change.top;
+
+                        f(Change {
+                            .version = change.version,
+                            .left = change.left + dx,
+                            .top = change.top + dy,
+                            .right = change.right + dx,
+                            .bottom = change.bottom + dy
+                        });
+                    });
+                }
+
+                return true;
+            }
+
+            /**
+             * Fetches every unknown cell from the delegate.
+             * 
+             * Reads on a fully known grid don't modify it, so it can be
+             * shared between threads as long as nothing writes to it.
+             */
+            void load() {
+                for (int y = 0; m_unknown > 0 && y < m_height; y++) {
+                    fill(Axis::Y, y, 0, m_width - 1);
+                }
+
+                if (m_dirty) update_clearance();
+            }
+
+            /**
+             * @param y row, inside the grid.
+             * 
+             * @return the packed passability of a row, one bit per cell, as
+             *         `bits::words(width())` words, with cells that have walls
+             *         as blocked. Unknown cells on it are fetched first. The
+             *         words may be overwritten by the next call.
+             */
+            const bits::word_t* row(int y) {
+                fill(Axis::Y, y, 0, m_width - 1);
+                if (!has_walls()) return line(Axis::Y, y);
+
+                const bits::word_t* cells = line(Axis::Y, y);
+                const bits::word_t* walled = m_walled_rows.data()
+                    + y * m_row_words;
+
+                m_row_buffer.resize(m_row_words);
+                for (int w = 0; w < m_row_words; w++) {
+                    m_row_buffer[w] = cells[w] & ~walled[w];
+                }
+
+                return m_row_buffer.data();
+            }
+
+            /**
+             * Builds an index with the clearance of every cell, i.e. the
+             * number of free cells next to it in each direction, so that the
+             * distance a line segment can be swept before hitting a blocked
+             * cell or a wall is found with a single pass over it.
+             * 
+             * The whole grid is fetched to build the index. Afterwards, it is
+             * kept up to date by recomputing the rows and columns of cells
+             * that are set or invalidated.
+             */
+            void build_clearance() {
+                for (auto& clearance : m_clearance) {
+                    clearance.assign(m_width * m_height, 0);
+                }
+
+                m_dirty_rows.assign(m_height, true);
+                m_dirty_cols.assign(m_width, true);
+                m_dirty = true;
+
+                load();
+            }
+
+            /**
+             * @return whether the grid has a clearance index.
+             */
+            bool has_clearance() const { return !m_clearance[0].empty(); }
+
+            /**
+             * Requires a clearance index.
+             * 
+             * @param cardinal direction to look at.
+             * @param fixed fixed coordinate of the line, inside the grid.
+             * @param min first cell on the line, inside the grid.
+             * @param max last cell on the line (inclusive), inside the grid.
+             * 
+             * @return how many times the line segment can be stepped towards
+             *         a direction until it hits a blocked cell, a wall or the
+             *         edge of the grid, assuming it is free.
+             */
+            [[gnu::hot]]
+            int clearance(Cardinal cardinal, int fixed, int min, int max) {
+                assert(has_clearance());
+                assert(fixed >= 0 && fixed < lines(axis(cardinal)));
+
+                if (m_dirty) update_clearance();
+
+                int offset = fixed * length(axis(cardinal));
+                const uint16_t* line = m_clearance[direction(cardinal)].data()
+                    + offset;
+
+                int distance = *std::min_element(line + min, line + max + 1);
+                if (!has_walls() || min == max) return distance;
+
+                const uint16_t* edges = m_edge_clearance[direction(cardinal)]
+                    .data() + offset;
+
+                return std::min<int>(
+                    distance,
+                    *std::min_element(edges + min, edges + max)
+                );
+            }
+
+            /**
+             * @param axis axis of the fixed coordinate.
+             * @param fixed fixed coordinate of the line.
+             * @param min first cell on the line.
+             * @param max last cell on the line (inclusive).
+             * 
+             * @return whether all cells on the line segment are free, with no
+             *         walls between them.
+             */
+            [[gnu::hot]]
+            bool all_free(Axis axis, int fixed, int min, int max) {
+                if (fixed < 0 || fixed >= lines(axis)) return false;
+                if (min < 0 || max >= length(axis)) return false;
+
+                REA_STAR_GRID_COUNT(probes, max - min + 1);
+
+                fill(axis, fixed, min, max);
+                if (!bits::all(line(axis, fixed), min, max)) return false;
+
+                return !has_walls()
+                    || bits::find<true>(along(axis, fixed), min, max - 1)
+                        >= max;
+            }
+
+            /**
+             * @param cardinal direction to step towards.
+             * @param fixed fixed coordinate of the line, inside the grid.
+             * @param min first cell on the line.
+             * @param max last cell on the line (inclusive).
+             * 
+             * @return whether the line segment can be stepped once towards a
+             *         direction without crossing any walls, or false if that
+             *         leaves the grid. Cells themselves are not checked.
+             */
+            [[gnu::hot]]
+            bool all_open(Cardinal cardinal, int fixed, int min, int max) {
+                Axis a = axis(cardinal);
+
+                int next = fixed + step(cardinal);
+                if (next < 0 || next >= lines(a)) return false;
+                if (min < 0 || max >= length(a)) return false;
+
+                // Walls on either side of the edges count.
+                fill(a, fixed, min, max);
+                fill(a, next, min, max);
+
+                return !has_walls()
+                    || bits::find<true>(crossing(cardinal, fixed), min, max)
+                        > max;
+            }
+
+            /**
+             * @param axis axis of the fixed coordinate.
+             * @param fixed fixed coordinate of the line, inside the grid.
+             * @param min first cell on the line, inside the grid.
+             * @param max last cell on the line (inclusive), inside the grid.
+             * 
+             * @return the first free cell on the line segment, or max + 1 if
+             *         there is none.
+             */
+            [[gnu::hot]]
+            int find_free(Axis axis, int fixed, int min, int max) {
+                REA_STAR_GRID_COUNT(probes, max - min + 1);
+
+                fill(axis, fixed, min, max);
+                return bits::find<true>(line(axis, fixed), min, max);
+            }
+
+            /**
+             * @param axis axis of the fixed coordinate.
+             * @param fixed fixed coordinate of the line, inside the grid.
+             * @param min first cell on the line, inside the grid.
+             * @param max last cell on the line (inclusive), inside the grid.
+             * 
+             * @return the first blocked cell on the line segment, or max + 1
+             *         if there is none. Cells past a wall count as blocked.
+             */
+            [[gnu::hot]]
+            int find_blocked(Axis axis, int fixed, int min, int max) {
+                REA_STAR_GRID_COUNT(probes, max - min + 1);
+
+                fill(axis, fixed, min, max);
+
+                int i = bits::find<false>(line(axis, fixed), min, max);
+                if (!has_walls()) return i;
+
+                return std::min(
+                    i,
+                    bits::find<true>(along(axis, fixed), min, i - 1) + 1
+                );
+            }
+
+            /**
+             * @param axis axis of the fixed coordinate.
+             * @param fixed fixed coordinate of the line, inside the grid.
+             * @param min first cell on the line, inside the grid.
+             * @param max last cell on the line (inclusive), inside the grid.
+             * 
+             * @return the last blocked cell on the line segment, or min - 1
+             *         if there is none. Cells before a wall count as blocked.
+             */
+            [[gnu::hot]]
+            int rfind_blocked(Axis axis, int fixed, int min, int max) {
+                REA_STAR_GRID_COUNT(probes, max - min + 1);
+
+                fill(axis, fixed, min, max);
+
+                int i = bits::rfind<false>(line(axis, fixed), min, max);
+                if (!has_walls()) return i;
 
-                bool v = m_delegate(p).isTrue();
-                m_mask[i] = true;
-                m_cache[i] = v;
-                return v;
+                int first = std::max(i, min);
+                return std::max(
+                    i,
+                    bits::rfind<true>(along(axis, fixed), first, max - 1)
+                );
             }
 
+            /**
+             * @return the width of the grid, covering both copies of the map
+             *         on grids that loop horizontally.
+             */
             int width() const { return m_width; }
+
+            /**
+             * @return the height of the grid, covering both copies of the
+             *         map on grids that loop vertically.
+             */
             int height() const { return m_height; }
 
+            int map_width() const { return m_map_width; }
+            int map_height() const { return m_map_height; }
+
+            Topology topology() const { return m_topology; }
+
+            /**
+             * @return whether the grid loops along any axis.
+             */
+            bool loops() const {
+                return m_topology.loop_x || m_topology.loop_y;
+            }
+
+            /**
+             * @param p point on the grid.
+             * 
+             * @return the point on the map a point on any copy stands for.
+             */
+            Point wrap(const Point& p) const {
+                return Point {
+                    .x = p.x % m_map_width,
+                    .y = p.y % m_map_height
+                };
+            }
+
+            /**
+             * @param p point on the map.
+             * 
+             * @return the copy of a point at least half the map away from
+             *         the edges of the grid along every axis it loops on, as
+             *         the center of a search window.
+             */
+            Point unwrap(const Point& p) const {
+                Point q = p;
+                if (m_topology.loop_x && q.x < m_map_width / 2) {
+                    q.x += m_map_width;
+                }
+
+                if (m_topology.loop_y && q.y < m_map_height / 2) {
+                    q.y += m_map_height;
+                }
+
+                return q;
+            }
+
+            /**
+             * Calls a function on every copy of a point on the grid.
+             * 
+             * @param p point on the map.
+             * @param f function taking each copy.
+             */
+            template <typename F>
+            void for_each_image(const Point& p, F f) const {
+                int columns = m_topology.loop_x ? 2 : 1,
+                    rows = m_topology.loop_y ? 2 : 1;
+
+                for (int j = 0; j < rows; j++) {
+                    for (int i = 0; i < columns; i++) {
+                        f(Point {
+                            .x = p.x + i * m_map_width,
+                            .y = p.y + j * m_map_height
+                        });
+                    }
+                }
+            }
+
         private:
             int m_width;
             int m_height;
-            emscripten::val m_delegate;
-            std::vector<bool> m_mask;
-            std::vector<bool> m_cache;
+            int m_map_width;
+            int m_map_height;
+            Topology m_topology;
+            int m_row_words;
+            int m_col_words;
+            int m_unknown;
+            uint32_t m_version = next_version();
+            delegate_t m_delegate;
+            walls_delegate_t m_walls_delegate;
+
+            /**
+             * Regions changed by the latest writes, oldest first.
+             */
+            std::vector<Change> m_changes;
+
+            /**
+             * Latest version whose changes were dropped from the journal.
+             * Changes made before the grid was built are unknown too.
+             */
+            uint32_t m_forgotten = m_version;
+
+            std::vector<bits::word_t> m_rows;
+            std::vector<bits::word_t> m_cols;
+            std::vector<bits::word_t> m_known_rows;
+            std::vector<bits::word_t> m_known_cols;
+
+            /**
+             * Walls of each cell, row-major. Walls and everything derived
+             * from them are only allocated once a cell has any.
+             */
+            std::vector<uint8_t> m_walls;
+
+            /**
+             * Cells with any walls, packed by rows.
+             */
+            std::vector<bits::word_t> m_walled_rows;
+
+            /**
+             * Walled edges between horizontal neighbors, each on the bit of
+             * the cell on their left, packed by rows and by columns.
+             */
+            std::vector<bits::word_t> m_hwalls_rows;
+            std::vector<bits::word_t> m_hwalls_cols;
+
+            /**
+             * Walled edges between vertical neighbors, each on the bit of the
+             * cell above them, packed by rows and by columns.
+             */
+            std::vector<bits::word_t> m_vwalls_rows;
+            std::vector<bits::word_t> m_vwalls_cols;
+
+            std::vector<bits::word_t> m_row_buffer;
+
+            /**
+             * Clearance of each cell by direction (north, south, west and
+             * east), laid out along the lines their intervals lie on: by rows
+             * for north and south, and by columns for west and east.
+             */
+            std::vector<uint16_t> m_clearance[4];
+
+            /**
+             * Clearance of each edge along the lines, by direction, laid out
+             * like cell clearance: how many times it can be stepped before
+             * hitting a wall. Only built on grids with walls.
+             */
+            std::vector<uint16_t> m_edge_clearance[4];
+
+            std::vector<bool> m_dirty_rows;
+            std::vector<bool> m_dirty_cols;
+            bool m_dirty = false;
+
+            static uint32_t next_version() {
+                static std::atomic<uint32_t> versions = 0;
+                return ++versions;
+            }
+
+            /**
+             * Gives the grid a new version after a write to a region of the
+             * map, and adds the write to the change journal.
+             */
+            void record(int left, int top, int right, int bottom) {
+                m_version = next_version();
+
+                if (m_changes.size() == JOURNAL_SIZE) {
+                    m_forgotten = m_changes.front().version;
+                    m_changes.erase(m_changes.begin());
+                }
+
+                m_changes.push_back(Change {
+                    .version = m_version,
+                    .left = left,
+                    .top = top,
+                    .right = right,
+                    .bottom = bottom
+                });
+            }
+
+            static int direction(Cardinal cardinal) {
+                int c = static_cast<int>(cardinal);
+                return ((c >> 3) & 0x2) | (c & 0x1);
+            }
+
+            int row_bit(int x, int y) const {
+                return y * m_row_words * bits::WORD_BITS + x;
+            }
+
+            int col_bit(int x, int y) const {
+                return x * m_col_words * bits::WORD_BITS + y;
+            }
+
+            int lines(Axis axis) const {
+                return axis == Axis::X ? m_width : m_height;
+            }
+
+            int length(Axis axis) const {
+                return axis == Axis::X ? m_height : m_width;
+            }
+
+            const bits::word_t* line(Axis axis, int fixed) const {
+                return axis == Axis::X
+                    ? m_cols.data() + fixed * m_col_words
+                    : m_rows.data() + fixed * m_row_words;
+            }
+
+            /**
+             * @return the packed walls between consecutive cells on a line.
+             */
+            const bits::word_t* along(Axis axis, int fixed) const {
+                return axis == Axis::X
+                    ? m_vwalls_cols.data() + fixed * m_col_words
+                    : m_hwalls_rows.data() + fixed * m_row_words;
+            }
+
+            /**
+             * @return the packed walls between a line and the next one
+             *         towards a direction.
+             */
+            const bits::word_t* crossing(Cardinal cardinal, int fixed) const {
+                int edge = fixed + std::min(step(cardinal), 0);
+
+                return axis(cardinal) == Axis::X
+                    ? m_hwalls_cols.data() + edge * m_col_words
+                    : m_vwalls_rows.data() + edge * m_row_words;
+            }
+
+            bool known(int x, int y) const {
+                return m_known_rows[row_bit(x, y) / bits::WORD_BITS]
+                    & bits::bit(x);
+            }
+
+            void know(int x, int y) {
+                m_known_rows[row_bit(x, y) / bits::WORD_BITS] |= bits::bit(x);
+                m_known_cols[col_bit(x, y) / bits::WORD_BITS] |= bits::bit(y);
+            }
+
+            static void put(
+                std::vector<bits::word_t>& words,
+                int i,
+                bool value
+            ) {
+                auto& word = words[i / bits::WORD_BITS];
+
+                if (value) word |= bits::bit(i);
+                else word &= ~bits::bit(i);
+            }
+
+            void store(int x, int y, bool value) {
+                put(m_rows, row_bit(x, y), value);
+                put(m_cols, col_bit(x, y), value);
+            }
+
+            void store_walls(int x, int y, int mask) {
+                if (!has_walls()) {
+                    if (mask == 0) return;
+
+                    m_walls.assign(m_width * m_height, 0);
+                    m_walled_rows.assign(m_rows.size(), 0);
+                    m_hwalls_rows.assign(m_rows.size(), 0);
+                    m_hwalls_cols.assign(m_cols.size(), 0);
+                    m_vwalls_rows.assign(m_rows.size(), 0);
+                    m_vwalls_cols.assign(m_cols.size(), 0);
+                }
+
+                m_walls[x + y * m_width] = mask;
+                put(m_walled_rows, row_bit(x, y), mask != 0);
+
+                if (x > 0) store_hwall(x - 1, y);
+                if (x + 1 < m_width) store_hwall(x, y);
+                if (y > 0) store_vwall(x, y - 1);
+                if (y + 1 < m_height) store_vwall(x, y);
+            }
+
+            /**
+             * Recomputes the edge between a cell and its east neighbor.
+             */
+            void store_hwall(int x, int y) {
+                bool walled = (m_walls[x + y * m_width] & wall(Cardinal::EAST))
+                    || (m_walls[x + 1 + y * m_width] & wall(Cardinal::WEST));
+
+                put(m_hwalls_rows, row_bit(x, y), walled);
+                put(m_hwalls_cols, col_bit(x, y), walled);
+            }
+
+            /**
+             * Recomputes the edge between a cell and its south neighbor.
+             */
+            void store_vwall(int x, int y) {
+                bool walled = (m_walls[x + y * m_width] & wall(Cardinal::SOUTH))
+                    || (m_walls[x + (y + 1) * m_width] & wall(Cardinal::NORTH));
+
+                put(m_vwalls_rows, row_bit(x, y), walled);
+                put(m_vwalls_cols, col_bit(x, y), walled);
+            }
+
+            /**
+             * Fetches a cell from the delegates, storing it on every copy.
+             */
+            [[gnu::cold]]
+            void fetch(int x, int y) {
+                REA_STAR_GRID_COUNT(fetches, 1);
+
+                Point p = wrap(Point { .x = x, .y = y });
+
+                bool value = m_delegate(p);
+                int mask = m_walls_delegate ? m_walls_delegate(p) & 0xf : 0;
+
+                for_each_image(p, [&](const Point& q) {
+                    store(q.x, q.y, value);
+                    if (m_walls_delegate) store_walls(q.x, q.y, mask);
+
+                    know(q.x, q.y);
+                    m_unknown--;
+                });
+            }
+
+            /**
+             * Drops the known passability of every cell in a rectangular
+             * region inside the grid.
+             */
+            void forget(int left, int top, int right, int bottom) {
+                for (int y = top; y <= bottom; y++) {
+                    for (int x = left; x <= right; x++) {
+                        if (!known(x, y)) continue;
+
+                        m_known_rows[row_bit(x, y) / bits::WORD_BITS]
+                            &= ~bits::bit(x);
+
+                        m_known_cols[col_bit(x, y) / bits::WORD_BITS]
+                            &= ~bits::bit(y);
+
+                        m_unknown++;
+                    }
+                }
+
+                // Refetched walls may change the edges the region shares
+                // with the cells right before it.
+                if (has_clearance()) {
+                    dirty(
+                        std::max(left - 1, 0),
+                        std::max(top - 1, 0),
+                        right,
+                        bottom
+                    );
+                }
+            }
+
+            void require(int x, int y) {
+                if (m_unknown > 0 && !known(x, y)) fetch(x, y);
+            }
+
+            /**
+             * Fetches every unknown cell on a line segment.
+             */
+            void fill(Axis axis, int fixed, int min, int max) {
+                if (m_unknown == 0) return;
+
+                const bits::word_t* known = axis == Axis::X
+                    ? m_known_cols.data() + fixed * m_col_words
+                    : m_known_rows.data() + fixed * m_row_words;
+
+                for (
+                    int i = bits::find<false>(known, min, max);
+                    i <= max;
+                    i = bits::find<false>(known, i + 1, max)
+                ) {
+                    if (axis == Axis::X) fetch(fixed, i);
+                    else fetch(i, fixed);
+                }
+            }
+
+            bool free(int x, int y) const {
+                return m_rows[row_bit(x, y) / bits::WORD_BITS] & bits::bit(x);
+            }
+
+            bool walled(int x, int y) const {
+                return has_walls() && m_walls[x + y * m_width] != 0;
+            }
+
+            /**
+             * @return whether the edge between a cell and its east neighbor
+             *         is open.
+             */
+            bool open_h(int x, int y) const {
+                return !has_walls()
+                    || !(m_hwalls_rows[row_bit(x, y) / bits::WORD_BITS]
+                        & bits::bit(x));
+            }
+
+            /**
+             * @return whether the edge between a cell and its south neighbor
+             *         is open.
+             */
+            bool open_v(int x, int y) const {
+                return !has_walls()
+                    || !(m_vwalls_rows[row_bit(x, y) / bits::WORD_BITS]
+                        & bits::bit(x));
+            }
+
+            void dirty(int left, int top, int right, int bottom) {
+                for (int y = top; y <= bottom; y++) m_dirty_rows[y] = true;
+                for (int x = left; x <= right; x++) m_dirty_cols[x] = true;
+                m_dirty = true;
+            }
+
+            /**
+             * Recomputes the clearance of every cell on dirty lines. Changing
+             * a cell affects the vertical clearance along its column and the
+             * horizontal clearance along its row. Edges along rows are kept
+             * with the column of the cell on their left, and edges along
+             * columns with the row of the cell above them.
+             */
+            [[gnu::cold]]
+            void update_clearance() {
+                m_dirty = false;
+
+                // Fetching dirty lines may bring in the first walls.
+                for (int x = 0; x < m_width; x++) {
+                    if (m_dirty_cols[x]) fill(Axis::X, x, 0, m_height - 1);
+                }
+
+                for (int y = 0; y < m_height; y++) {
+                    if (m_dirty_rows[y]) fill(Axis::Y, y, 0, m_width - 1);
+                }
+
+                if (has_walls() && m_edge_clearance[0].empty()) {
+                    for (auto& clearance : m_edge_clearance) {
+                        clearance.assign(m_width * m_height, 0);
+                    }
+
+                    m_dirty_rows.assign(m_height, true);
+                    m_dirty_cols.assign(m_width, true);
+                }
+
+                auto& north = m_clearance[direction(Cardinal::NORTH)];
+                auto& south = m_clearance[direction(Cardinal::SOUTH)];
+                auto& west = m_clearance[direction(Cardinal::WEST)];
+                auto& east = m_clearance[direction(Cardinal::EAST)];
+
+                auto& north_edges = m_edge_clearance[
+                    direction(Cardinal::NORTH)
+                ];
+                auto& south_edges = m_edge_clearance[
+                    direction(Cardinal::SOUTH)
+                ];
+                auto& west_edges = m_edge_clearance[direction(Cardinal::WEST)];
+                auto& east_edges = m_edge_clearance[direction(Cardinal::EAST)];
+
+                for (int x = 0; x < m_width; x++) {
+                    if (!m_dirty_cols[x]) continue;
+                    m_dirty_cols[x] = false;
+
+                    for (int y = 1; y < m_height; y++) {
+                        north[x + y * m_width] = free(x, y - 1)
+                                && open_v(x, y - 1)
+                            ? north[x + (y - 1) * m_width] + 1
+                            : 0;
+                    }
+
+                    for (int y = m_height - 2; y >= 0; y--) {
+                        south[x + y * m_width] = free(x, y + 1)
+                                && open_v(x, y)
+                            ? south[x + (y + 1) * m_width] + 1
+                            : 0;
+                    }
+
+                    if (!has_walls() || x + 1 == m_width) continue;
+
+                    for (int y = 1; y < m_height; y++) {
+                        north_edges[x + y * m_width] = open_h(x, y - 1)
+                            ? north_edges[x + (y - 1) * m_width] + 1
+                            : 0;
+                    }
+
+                    for (int y = m_height - 2; y >= 0; y--) {
+                        south_edges[x + y * m_width] = open_h(x, y + 1)
+                            ? south_edges[x + (y + 1) * m_width] + 1
+                            : 0;
+                    }
+                }
+
+                for (int y = 0; y < m_height; y++) {
+                    if (!m_dirty_rows[y]) continue;
+                    m_dirty_rows[y] = false;
+
+                    for (int x = 1; x < m_width; x++) {
+                        west[y + x * m_height] = free(x - 1, y)
+                                && open_h(x - 1, y)
+                            ? west[y + (x - 1) * m_height] + 1
+                            : 0;
+                    }
+
+                    for (int x = m_width - 2; x >= 0; x--) {
+                        east[y + x * m_height] = free(x + 1, y)
+                                && open_h(x, y)
+                            ? east[y + (x + 1) * m_height] + 1
+                            : 0;
+                    }
+
+                    if (!has_walls() || y + 1 == m_height) continue;
+
+                    for (int x = 1; x < m_width; x++) {
+                        west_edges[y + x * m_height] = open_v(x - 1, y)
+                            ? west_edges[y + (x - 1) * m_height] + 1
+                            : 0;
+                    }
+
+                    for (int x = m_width - 2; x >= 0; x--) {
+                        east_edges[y + x * m_height] = open_v(x + 1, y)
+                            ? east_edges[y + (x + 1) * m_height] + 1
+                            : 0;
+                    }
+                }
+            }
     };
 };
@@ -0,0 +1,206 @@
+/**
+ * @file indexed_heap.hpp
+ * 
+ * @author Brandt
+ * @date 2020/10/15
+ * @license Zlib
+ * 
+ * Binary heap with decrease-key, which can be reset in constant time.
+ */
+
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+namespace rea_star {
+    /**
+     * Binary min-heap of integer keys, where each key is in the heap at most
+     * once and its priority can be lowered in place.
+     * 
+     * The position of each key on the heap is tagged with the generation it
+     * was written on, like on a `StampedGrid`, so that clearing the heap only
+     * takes bumping the generation.
+     * 
+     * @tparam P priority type, ordered by `<`.
+     * @tparam S unsigned type of the generation stamps, which wrap around
+     *           once every value has been used.
+     */
+    template <typename P, typename S = uint32_t>
+    class IndexedHeap {
+        public:
+            IndexedHeap() = default;
+
+            /**
+             * Empties the heap, making room for keys up to a given size.
+             * Memory is only reallocated when the key range grows.
+             * 
+             * @param size number of possible keys.
+             */
+            void reset(size_t size) {
+                if (size > m_positions.size()) {
+                    m_positions.resize(size, Position { 0, 0 });
+                }
+
+                m_entries.clear();
+
+                if (++m_generation == 0) {
+                    for (Position& position : m_positions) position.stamp = 0;
+                    m_generation = 1;
+                }
+            }
+
+            bool empty() const { return m_entries.empty(); }
+            size_t size() const { return m_entries.size(); }
+
+            /**
+             * @return whether a key is on the heap.
+             */
+            bool contains(uint32_t key) const {
+                assert(key < m_positions.size());
+                return m_positions[key].stamp == m_generation;
+            }
+
+            /**
+             * Adds a key to the heap, or lowers its priority if it is already
+             * there with a higher one.
+             * 
+             * @param key key, less than the size given on reset.
+             * @param priority priority for the key.
+             * 
+             * @return whether the heap changed.
+             */
+            bool push(uint32_t key, P priority) {
+                assert(key < m_positions.size());
+
+                Position& position = m_positions[key];
+                if (position.stamp != m_generation) {
+                    position.stamp = m_generation;
+                    position.index = m_entries.size();
+                    m_entries.push_back(Entry { priority, key });
+                } else if (priority < m_entries[position.index].priority) {
+                    m_entries[position.index].priority = priority;
+                } else {
+                    return false;
+                }
+
+                sift_up(position.index);
+                return true;
+            }
+
+            /**
+             * Replaces the priority of a key on the heap.
+             * 
+             * @param key key on the heap.
+             * @param priority new priority for the key.
+             */
+            void update(uint32_t key, P priority) {
+                assert(contains(key));
+
+                size_t index = m_positions[key].index;
+                m_entries[index].priority = priority;
+
+                sift_up(index);
+                sift_down(m_positions[key].index);
+            }
+
+            /**
+             * @return the priority of a key on the heap.
+             */
+            const P& priority(uint32_t key) const {
+                assert(contains(key));
+                return m_entries[m_positions[key].index].priority;
+            }
+
+            /**
+             * @return the key with the lowest priority on the heap, which must
+             *         not be empty.
+             */
+            uint32_t top() const {
+                assert(!empty());
+                return m_entries.front().key;
+            }
+
+            /**
+             * Removes the key with the lowest priority from the heap, which
+             * must not be empty.
+             * 
+             * @return the removed key.
+             */
+            uint32_t pop() {
+                assert(!empty());
+
+                uint32_t key = m_entries.front().key;
+                m_positions[key].stamp = 0;
+
+                Entry last = m_entries.back();
+                m_entries.pop_back();
+
+                if (!m_entries.empty()) {
+                    m_entries.front() = last;
+                    m_positions[last.key].index = 0;
+                    sift_down(0);
+                }
+
+                return key;
+            }
+
+        private:
+            struct Entry {
+                P priority;
+                uint32_t key;
+            };
+
+            struct Position {
+                S stamp;
+                uint32_t index;
+            };
+
+            std::vector<Entry> m_entries;
+            std::vector<Position> m_positions;
+            S m_generation = 0;
+
+            void place(size_t index, const Entry& entry) {
+                m_entries[index] = entry;
+                m_positions[entry.key].index = index;
+            }
+
+            void sift_up(size_t index) {
+                Entry entry = m_entries[index];
+
+                while (index > 0) {
+                    size_t parent = (index - 1) / 2;
+                    if (!(entry.priority < m_entries[parent].priority)) break;
+
+                    place(index, m_entries[parent]);
+                    index = parent;
+                }
+
+                place(index, entry);
+            }
+
+            void sift_down(size_t index) {
+                Entry entry = m_entries[index];
+                size_t size = m_entries.size();
+
+                for (;;) {
+                    size_t child = 2 * index + 1;
+                    if (child >= size) break;
+
+                    if (
+                        child + 1 < size
+                        && m_entries[child + 1].priority
+                            < m_entries[child].priority
+                    ) child++;
+
+                    if (!(m_entries[child].priority < entry.priority)) break;
+
+                    place(index, m_entries[child]);
+                    index = child;
+                }
+
+                place(index, entry);
+            }
+    };
+};
@@ -42,17 +42,11 @@ bool Interval::contains(const Point& p) const {
 }
 
 bool Interval::is_free(Grid<bool>& g) const {
-    if (!is_valid(g)) return false;
-
-    for (int i = 0; i < length(); i++) {
-        Point p = at(i);
-        if (!g[p]) return false;
-    }
-
-    return true;
+    return g.all_free(axis(), m_fixed, m_min, m_max);
 }
 
-bool Interval::is_valid(const Grid<bool>& g) const {
+template <typename T>
+bool Interval::is_valid(const Grid<T>& g) const {
     int f = fixed();
     Axis a = axis();
     return f >= 0 && (
@@ -70,33 +64,11 @@ Interval Interval::clip(const Grid<T>& g) const {
     );
 }
 
-template Interval Interval::clip<bool>(const Grid<bool>& g) const;
-
-std::vector<Interval> Interval::free_subintervals(Grid<bool>& g) const {
-    Interval clipped = clip(g);
-    int len = clipped.length();
-    
-    std::vector<Interval> subIntervals;
-    subIntervals.reserve(len / 2);
-
-    Interval i(m_cardinal, m_fixed, m_min, m_min);
-
-    int start = 0;
-    do {
-        while (start < len && !g[clipped.at(start)]) start++;
+template bool Interval::is_valid<bool>(const Grid<bool>& g) const;
+template bool Interval::is_valid<uint8_t>(const Grid<uint8_t>& g) const;
 
-        if (start >= len) break;
-
-        int end = start;
-        while (end + 1 < len && g[clipped.at(end + 1)]) end++;
-
-        subIntervals.push_back(clipped.subinterval(start, end));
-
-        start = end + 1;
-    } while (start < len);
-
-    return subIntervals;
-}
+template Interval Interval::clip<bool>(const Grid<bool>& g) const;
+template Interval Interval::clip<uint8_t>(const Grid<uint8_t>& g) const;
 
 Interval Interval::parent() const {
     return Interval(
@@ -12,6 +12,7 @@
 
 #include "grid.hpp"
 #include "cardinal.hpp"
+#include "cost_grid.hpp"
 
 namespace rea_star {
     class Interval {
@@ -37,13 +38,70 @@ namespace rea_star {
         [[gnu::hot]]
         bool is_free(Grid<bool>& g) const;
 
+        template <typename T>
         [[gnu::hot]]
-        bool is_valid(const Grid<bool>& g) const;
+        bool is_valid(const Grid<T>& g) const;
 
         template <typename T>
         Interval clip(const Grid<T>& g) const;
 
-        std::vector<Interval> free_subintervals(Grid<bool>& g) const;
+        /**
+         * Calls a function on every run of free cells on the interval,
+         * clipped to the grid, in order, without allocating them.
+         * 
+         * @param g boolean matrix.
+         * @param f function taking each run as an interval, returning true
+         *        to stop.
+         * 
+         * @return whether the function stopped the iteration.
+         */
+        template <typename F>
+        bool for_each_free_subinterval(Grid<bool>& g, F f) const {
+            Interval clipped = clip(g);
+            int min = clipped.m_min,
+                max = clipped.m_max;
+
+            Axis a = axis();
+
+            int start = g.find_free(a, m_fixed, min, max);
+            while (start <= max) {
+                int end = g.find_blocked(a, m_fixed, start, max) - 1;
+                if (f(Interval(m_cardinal, m_fixed, start, end))) return true;
+
+                start = g.find_free(a, m_fixed, end + 1, max);
+            }
+
+            return false;
+        }
+
+        /**
+         * Calls a function on every run of free cells with the same cost on
+         * the interval, clipped to the grid, in order.
+         * 
+         * @param g cost grid.
+         * @param f function taking each run as an interval, returning true
+         *        to stop.
+         * 
+         * @return whether the function stopped the iteration.
+         */
+        template <typename F>
+        bool for_each_uniform_subinterval(const Grid<uint8_t>& g, F f) const {
+            Interval clipped = clip(g);
+            int min = clipped.m_min,
+                max = clipped.m_max;
+
+            Axis a = axis();
+
+            int start = g.find_free(a, m_fixed, min, max);
+            while (start <= max) {
+                int end = g.find_change(a, m_fixed, start, max) - 1;
+                if (f(Interval(m_cardinal, m_fixed, start, end))) return true;
+
+                start = g.find_free(a, m_fixed, end + 1, max);
+            }
+
+            return false;
+        }
 
         Interval parent() const;
 
@@ -26,37 +26,93 @@ Rect::Rect(const Interval& interval) {
 }
 
 Rect Rect::expand_point(const Point& p, Grid<bool>& g) {
-    int l = p.x, t = p.y,
-        r = l, b = t;
+    if (g.has_clearance() && g.enterable(p)) {
+        int l = p.x - g.clearance(Cardinal::WEST, p.x, p.y, p.y),
+            r = p.x + g.clearance(Cardinal::EAST, p.x, p.y, p.y);
+
+        return Rect(
+            l,
+            p.y - g.clearance(Cardinal::NORTH, p.y, l, r),
+            r,
+            p.y + g.clearance(Cardinal::SOUTH, p.y, l, r)
+        );
+    }
+
+    int l = g.rfind_blocked(Axis::Y, p.y, 0, p.x) + 1,
+        r = g.find_blocked(Axis::Y, p.y, p.x, g.width() - 1) - 1,
+        t = p.y,
+        b = t;
 
-    while (r < g.width() && g[{ .x = r, .y = t }]) r++;
-    r--;
+    while (
+        g.all_open(Cardinal::SOUTH, b, l, r)
+        && g.all_free(Axis::Y, b + 1, l, r)
+    ) b++;
 
-    while (l >= 0 && g[{ .x = l, .y = t }]) l--;
-    l++;
+    while (
+        g.all_open(Cardinal::NORTH, t, l, r)
+        && g.all_free(Axis::Y, t - 1, l, r)
+    ) t--;
 
-    while (b < g.height()) {
-        for (int x = l; x <= r; x++) {
-            if (!g[{ .x = x, .y = b }]) goto bottom_done;
-        }
-        b++;
+    return Rect(l, t, r, b);
+}
+
+Rect Rect::expand_interval(const Interval& interval, Grid<bool>& g) {
+    if (g.has_clearance()) {
+        if (!interval.is_free(g)) return Rect(interval);
+
+        Cardinal cardinal = interval.cardinal();
+        int distance = g.clearance(
+            cardinal,
+            interval.fixed(),
+            interval.min(),
+            interval.max()
+        );
+
+        return between(interval, Interval(
+            cardinal,
+            interval.fixed() + distance * step(cardinal),
+            interval.min(),
+            interval.max()
+        ));
     }
-    bottom_done: b--;
 
-    while (t >= 0 && t < g.height()) {
-        for (int x = l; x <= r; x++) {
-            if (!g[{ .x = x, .y = t }]) goto top_done;
-        }
-        t--;
+    Interval expanded = interval;
+    for (Interval i = expanded; i.is_free(g); i.step()) {
+        expanded = i;
+        if (!g.all_open(i.cardinal(), i.fixed(), i.min(), i.max())) break;
     }
-    top_done: t++;
+
+    return between(interval, expanded);
+}
+
+Rect Rect::expand_point(const Point& p, const Grid<uint8_t>& g) {
+    uint8_t cost = g[p];
+    if (cost == 0) return Rect(p.x, p.y, p.x, p.y);
+
+    int l = g.rfind_change(Axis::Y, p.y, 0, p.x) + 1,
+        r = g.find_change(Axis::Y, p.y, p.x, g.width() - 1) - 1,
+        t = p.y,
+        b = t;
+
+    while (g.all_equal(Axis::Y, b + 1, l, r, cost)) b++;
+    while (g.all_equal(Axis::Y, t - 1, l, r, cost)) t--;
 
     return Rect(l, t, r, b);
 }
 
-Rect Rect::expand_interval(const Interval& interval, Grid<bool>& g) {
+Rect Rect::expand_interval(
+    const Interval& interval,
+    const Grid<uint8_t>& g
+) {
+    uint8_t cost = g[interval.at(0)];
+    Axis axis = interval.axis();
+
     Interval expanded = interval;
-    for (Interval i = expanded; i.is_free(g); i.step()) {
+    for (
+        Interval i = expanded;
+        g.all_equal(axis, i.fixed(), i.min(), i.max(), cost);
+        i.step()
+    ) {
         expanded = i;
     }
 
@@ -77,33 +133,16 @@ bool Rect::contains(const Point& p) const {
         && m_top <= p.y && p.y <= m_bottom;
 }
 
-std::vector<Point> Rect::boundaries() const {
-    std::vector<Point> points;
-    points.reserve((width() + height()) * 2);
-
-    for (int x = m_left; x <= m_right; x++) {
-        points.push_back({ .x = x, .y = m_top });
-        points.push_back({ .x = x, .y = m_bottom });
-    }
-
-    for (int y = m_top + 1; y < m_bottom; y++) {
-        points.push_back({ .x = m_left, .y = y });
-        points.push_back({ .x = m_right, .y = y });
-    }
-
-    return points;
-}
-
-std::vector<Interval> Rect::walls(Cardinal cardinal) const {
+std::array<Interval, 3> Rect::walls(Cardinal cardinal) const {
     switch (cardinal) {
     case Cardinal::NORTH:
-        return { east(), west(), north() };
+        return {{ east(), west(), north() }};
     case Cardinal::SOUTH:
-        return { east(), west(), south() };
+        return {{ east(), west(), south() }};
     case Cardinal::EAST:
-        return { north(), south(), east() };
+        return {{ north(), south(), east() }};
     case Cardinal::WEST:
-        return { north(), south(), west() };
+        return {{ north(), south(), west() }};
     }
 }
 
@@ -11,7 +11,7 @@
 #pragma once
 
 #include <algorithm>
-#include <vector>
+#include <array>
 
 #include "grid.hpp"
 #include "cardinal.hpp"
@@ -24,6 +24,23 @@ namespace rea_star {
         static Rect expand_point(const Point& p, Grid<bool>& g);
 
         static Rect expand_interval(const Interval& interval, Grid<bool>& g);
+
+        /**
+         * Expands a point into the largest rectangle around it on a cost
+         * grid where every cell has the same cost, growing horizontally
+         * first. Blocked points expand into themselves.
+         */
+        [[gnu::cold]]
+        static Rect expand_point(const Point& p, const Grid<uint8_t>& g);
+
+        /**
+         * Sweeps an interval on a cost grid towards its direction for as
+         * long as every cell it covers has the same cost as the interval.
+         */
+        static Rect expand_interval(
+            const Interval& interval,
+            const Grid<uint8_t>& g
+        );
         
         static Rect between(const Interval& a, const Interval& b) { return Rect(a).merge(Rect(b)); }
 
@@ -47,8 +64,25 @@ namespace rea_star {
 
         bool contains(const Point& p) const;
 
-        std::vector<Point> boundaries() const;
-        std::vector<Interval> walls(Cardinal cardinal) const;
+        /**
+         * Calls a function on every point on the edges of the rectangle.
+         * 
+         * @param f function taking each point.
+         */
+        template <typename F>
+        void for_each_boundary(F f) const {
+            for (int x = m_left; x <= m_right; x++) {
+                f(Point { .x = x, .y = m_top });
+                f(Point { .x = x, .y = m_bottom });
+            }
+
+            for (int y = m_top + 1; y < m_bottom; y++) {
+                f(Point { .x = m_left, .y = y });
+                f(Point { .x = m_right, .y = y });
+            }
+        }
+
+        std::array<Interval, 3> walls(Cardinal cardinal) const;
         Interval extend_neighbor_interval(Cardinal cardinal) const;
 
         int left() const { return m_left; }
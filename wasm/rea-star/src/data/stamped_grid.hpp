@@ -0,0 +1,101 @@
+/**
+ * @file stamped_grid.hpp
+ * 
+ * @author Brandt
+ * @date 2020/10/12
+ * @license Zlib
+ * 
+ * Grid map data type which can be reset in constant time.
+ */
+
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+#include "grid.hpp"
+
+namespace rea_star {
+    /**
+     * Grid where every cell is tagged with the generation it was last written
+     * on. Cells from older generations read as the default value, so that
+     * resetting the whole grid only takes bumping the generation.
+     * 
+     * Tags are stored next to their values, so that reading a cell only
+     * touches one cache line.
+     * 
+     * @tparam T type of the values on the grid.
+     */
+    template <typename T>
+    class StampedGrid {
+        public:
+            StampedGrid() = default;
+            StampedGrid(const StampedGrid&) = default;
+            StampedGrid(StampedGrid&&) = default;
+
+            /**
+             * Resets every cell to a default value, resizing the grid if
+             * needed. Memory is only reallocated when the grid grows.
+             * 
+             * @param width grid width.
+             * @param height grid height.
+             * @param defaultValue value for all cells.
+             */
+            void reset(int width, int height, T defaultValue) {
+                size_t size = static_cast<size_t>(width) * height;
+
+                if (size > m_cells.size()) m_cells.resize(size, Cell { 0, T {} });
+
+                m_width = width;
+                m_height = height;
+                m_default = defaultValue;
+
+                if (++m_generation == 0) {
+                    for (Cell& cell : m_cells) cell.stamp = 0;
+                    m_generation = 1;
+                }
+            }
+
+            [[gnu::hot]]
+            T operator[](const Point& p) const {
+                const Cell& cell = m_cells[index(p)];
+                return cell.stamp == m_generation ? cell.value : m_default;
+            }
+
+            [[gnu::hot]]
+            T& operator[](const Point& p) {
+                Cell& cell = m_cells[index(p)];
+                if (cell.stamp != m_generation) {
+                    cell.stamp = m_generation;
+                    cell.value = m_default;
+                }
+
+                return cell.value;
+            }
+
+            int width() const { return m_width; }
+            int height() const { return m_height; }
+
+        private:
+            int m_width = 0;
+            int m_height = 0;
+            uint32_t m_generation = 0;
+            T m_default;
+            struct Cell {
+                uint32_t stamp;
+                T value;
+            };
+
+            std::vector<Cell> m_cells;
+
+            size_t index(const Point& p) const {
+                assert(p.x >= 0);
+                assert(p.y >= 0);
+                assert(p.x < m_width);
+                assert(p.y < m_height);
+
+                return static_cast<size_t>(p.y) * m_width + p.x;
+            }
+    };
+};
@@ -1,23 +1,421 @@
 #include <emscripten/bind.h>
 
+#include <string>
+#include <unordered_map>
+
+#include "algorithm/distance_field.hpp"
+#include "algorithm/grid_astar.hpp"
+#include "algorithm/hierarchy.hpp"
+#include "algorithm/jump_point.hpp"
+#include "algorithm/path_cache.hpp"
 #include "algorithm/rea_star.hpp"
+#include "algorithm/solver_pool.hpp"
+#include "algorithm/weighted_rea_star.hpp"
 
+#include "data/cost_grid.hpp"
 #include "data/grid.hpp"
 #include "data/interval.hpp"
 
 using namespace emscripten;
 using namespace rea_star;
 
-val rectangle_expansion_astar_js(
+static_assert(sizeof(Point) == 2 * sizeof(int32_t), "points must be packed");
+
+path_t& path_buffer() {
+    static path_t buffer;
+    return buffer;
+}
+
+PathCache& path_cache() {
+    static PathCache cache;
+    return cache;
+}
+
+int cache_path(Point target, Grid<bool>& g, size_t size) {
+    const path_t& path = path_buffer();
+    if (size > 0 && path.back() == target) {
+        path_cache().insert(path.begin(), path.end(), g);
+    }
+
+    return size;
+}
+
+void cache_batch(
+    const PathBatch& batch,
+    const std::vector<PathQuery>& queries,
+    Grid<bool>& g
+) {
+    for (size_t i = 0; i < queries.size(); i++) {
+        auto begin = batch.points.begin() + batch.offsets[i],
+             end = batch.points.begin() + batch.offsets[i + 1];
+
+        if (begin != end && end[-1] == queries[i].target) {
+            path_cache().insert(begin, end, g);
+        }
+    }
+}
+
+SearchStats& last_search_stats() {
+    static SearchStats stats;
+    return stats;
+}
+
+std::unordered_map<const Grid<bool>*, SearchHistogram>& search_histograms() {
+    static std::unordered_map<const Grid<bool>*, SearchHistogram> histograms;
+    return histograms;
+}
+
+SearchStats* search_stats() {
+    last_search_stats() = SearchStats {};
+    return SEARCH_STATS_ENABLED ? &last_search_stats() : nullptr;
+}
+
+int record_search(const Grid<bool>& g, int size) {
+    if (SEARCH_STATS_ENABLED) search_histograms()[&g].add(last_search_stats());
+    return size;
+}
+
+val last_search_stats_js() {
+    if (!SEARCH_STATS_ENABLED) return val::null();
+
+    const SearchStats& stats = last_search_stats();
+
+    val result = val::object();
+    result.set("expansions", stats.expansions);
+    result.set("merged", stats.merged);
+    result.set("pushes", stats.pushes);
+    result.set("peakOpen", stats.peak_open);
+    result.set("subintervalScans", stats.subinterval_scans);
+    result.set("probes", double(stats.probes));
+    result.set("fetches", double(stats.fetches));
+    result.set("expandMicros", stats.expand_us);
+    result.set("successorMicros", stats.successor_us);
+    result.set("totalMicros", stats.total_us);
+
+    return result;
+}
+
+val search_histogram_js(const Grid<bool>& g) {
+    auto it = search_histograms().find(&g);
+    SearchHistogram histogram = it == search_histograms().end()
+        ? SearchHistogram {}
+        : it->second;
+
+    val expansions = val::array(), latency = val::array();
+    for (int i = 0; i < SearchHistogram::BUCKETS; i++) {
+        expansions.call<void>("push", histogram.expansions[i]);
+        latency.call<void>("push", histogram.latency[i]);
+    }
+
+    val result = val::object();
+    result.set("searches", histogram.searches);
+    result.set("expansions", expansions);
+    result.set("latency", latency);
+
+    return result;
+}
+
+void reset_search_histogram_js(const Grid<bool>& g) {
+    search_histograms().erase(&g);
+}
+
+int cached_path_js(
     Point source,
     Point target,
-    const Grid<bool>& g,
+    Grid<bool>& g,
     int maxlen = INT32_MAX
 ) {
-    auto path = rectangle_expansion_astar(source, target, g, maxlen);
+    path_buffer().clear();
+    return path_cache().find_path(source, target, g, path_buffer(), maxlen);
+}
+
+template <typename Policy>
+int rectangle_expansion_astar_js(
+    Point source,
+    Point target,
+    Grid<bool>& g,
+    int maxlen = INT32_MAX
+) {
+    size_t size = rectangle_expansion_astar<Policy>(
+        source,
+        target,
+        g,
+        path_buffer(),
+        maxlen,
+        search_stats()
+    );
+
+    return cache_path(target, g, record_search(g, size));
+}
+
+int rectangle_expansion_astar_nearest_js(
+    Point source,
+    val targets,
+    Grid<bool>& g,
+    int maxlen = INT32_MAX
+) {
+    static std::vector<Point> data;
+
+    data.resize(targets["length"].as<size_t>() / 2);
+    val(typed_memory_view(
+        data.size() * 2,
+        reinterpret_cast<int32_t*>(data.data())
+    )).call<void>("set", targets);
+
+    return record_search(g, rectangle_expansion_astar_nearest(
+        source,
+        data,
+        g,
+        path_buffer(),
+        maxlen,
+        search_stats()
+    ));
+}
+
+Hierarchy& hierarchy() {
+    static Hierarchy hierarchy;
+    return hierarchy;
+}
+
+int hierarchical_astar_js(Point source, Point target, Grid<bool>& g) {
+    path_buffer().clear();
+    return cache_path(
+        target,
+        g,
+        hierarchy().find_path(source, target, g, path_buffer())
+    );
+}
+
+int jump_point_search_js(
+    Point source,
+    Point target,
+    Grid<bool>& g,
+    int maxlen = INT32_MAX
+) {
+    return cache_path(target, g, jump_point_search(
+        source,
+        target,
+        g,
+        path_buffer(),
+        maxlen
+    ));
+}
+
+int grid_astar_js(
+    Point source,
+    Point target,
+    Grid<bool>& g,
+    int maxlen = INT32_MAX
+) {
+    return grid_astar(source, target, g, path_buffer(), maxlen);
+}
+
+int weighted_rectangle_expansion_astar_js(
+    Point source,
+    Point target,
+    Grid<uint8_t>& g,
+    int maxcost = INT32_MAX
+) {
+    return weighted_rectangle_expansion_astar(
+        source,
+        target,
+        g,
+        path_buffer(),
+        maxcost
+    );
+}
+
+int distance_field_path_js(
+    DistanceField& field,
+    Point source,
+    Point target,
+    Grid<bool>& g,
+    int radius
+) {
+    path_buffer().clear();
+    return field.find_path(source, target, g, path_buffer(), radius);
+}
+
+void search_begin_js(
+    REAStarSolver& search,
+    Point source,
+    Point target,
+    Grid<bool>& g,
+    int maxlen
+) {
+    search.begin(source, target, g, maxlen);
+}
+
+int search_step_js(REAStarSolver& search, int max_expansions) {
+    return static_cast<int>(search.step(max_expansions));
+}
+
+int search_step_for_js(REAStarSolver& search, int microseconds) {
+    return static_cast<int>(
+        search.step_for(std::chrono::microseconds(microseconds))
+    );
+}
 
-    if (path.has_value()) return val(path.value());
-    return val::undefined();
+int search_status_js(const REAStarSolver& search) {
+    return static_cast<int>(search.status());
+}
+
+int search_path_js(const REAStarSolver& search) {
+    path_buffer().clear();
+    return search.path(path_buffer());
+}
+
+val path_buffer_js() {
+    const path_t& path = path_buffer();
+
+    return val(typed_memory_view(
+        path.size() * 2,
+        reinterpret_cast<const int32_t*>(path.data())
+    ));
+}
+
+#ifndef REA_STAR_POOL_THREADS
+#define REA_STAR_POOL_THREADS 0
+#endif
+
+SolverPool& solver_pool() {
+    static SolverPool pool(REA_STAR_POOL_THREADS);
+    return pool;
+}
+
+const std::vector<PathQuery>& read_queries(val queries) {
+    static std::vector<int32_t> data;
+    static std::vector<PathQuery> result;
+
+    data.resize(queries["length"].as<size_t>());
+    val(typed_memory_view(data.size(), data.data())).call<void>("set", queries);
+
+    result.clear();
+    for (size_t i = 0; i + 5 <= data.size(); i += 5) {
+        result.push_back(PathQuery {
+            .source = { .x = data[i], .y = data[i + 1] },
+            .target = { .x = data[i + 2], .y = data[i + 3] },
+            .maxlen = data[i + 4]
+        });
+    }
+
+    return result;
+}
+
+val path_batch_js(const PathBatch& batch) {
+    val result = val::object();
+    result.set("points", val(typed_memory_view(
+        batch.points.size() * 2,
+        reinterpret_cast<const int32_t*>(batch.points.data())
+    )));
+
+    result.set("offsets", val(typed_memory_view(
+        batch.offsets.size(),
+        batch.offsets.data()
+    )));
+
+    return result;
+}
+
+val rectangle_expansion_astar_batch_js(val queries, Grid<bool>& g) {
+    static PathBatch batch;
+
+    const std::vector<PathQuery>& data = read_queries(queries);
+    rectangle_expansion_astar_batch(data, g, batch);
+    cache_batch(batch, data, g);
+
+    return path_batch_js(batch);
+}
+
+struct Submission {
+    std::vector<PathQuery> queries;
+    Grid<bool>* grid = nullptr;
+};
+
+Submission& submission() {
+    static Submission submission;
+    return submission;
+}
+
+void rectangle_expansion_astar_submit_js(val queries, Grid<bool>& g) {
+    const std::vector<PathQuery>& data = read_queries(queries);
+
+    submission().queries.assign(data.begin(), data.end());
+    submission().grid = &g;
+
+    solver_pool().submit(data, g);
+}
+
+bool rectangle_expansion_astar_ready_js() {
+    return solver_pool().ready();
+}
+
+val rectangle_expansion_astar_collect_js() {
+    static PathBatch batch;
+
+    solver_pool().collect(batch);
+
+    Submission& submitted = submission();
+    if (submitted.grid) cache_batch(batch, submitted.queries, *submitted.grid);
+    submitted.grid = nullptr;
+
+    return path_batch_js(batch);
+}
+
+Grid<bool>::delegate_t color_delegate(val map) {
+    val color = map["color"].call<val>("bind", map);
+    return [color](const Point& p) { return color(p).isTrue(); };
+}
+
+Grid<bool>::walls_delegate_t walls_delegate(val map) {
+    if (map["walls"].typeOf().as<std::string>() != "function") return nullptr;
+
+    val walls = map["walls"].call<val>("bind", map);
+    return [walls](const Point& p) { return walls(p).as<int>(); };
+}
+
+Topology topology(val map) {
+    return Topology {
+        .loop_x = map["loopsHorizontally"].isTrue(),
+        .loop_y = map["loopsVertically"].isTrue()
+    };
+}
+
+Grid<bool>* boolean_grid_from_map(val map) {
+    return new Grid<bool>(
+        map["width"].as<int>(),
+        map["height"].as<int>(),
+        color_delegate(map),
+        walls_delegate(map),
+        topology(map)
+    );
+}
+
+Grid<bool>* boolean_grid_from_buffer(val map, val buffer) {
+    int width = map["width"].as<int>(),
+        height = map["height"].as<int>();
+
+    std::vector<uint8_t> data(width * height);
+    val(typed_memory_view(data.size(), data.data())).call<void>("set", buffer);
+
+    return new Grid<bool>(
+        width,
+        height,
+        data,
+        color_delegate(map),
+        walls_delegate(map),
+        topology(map)
+    );
+}
+
+Grid<uint8_t>* cost_grid_from_buffer(val map, val buffer) {
+    int width = map["width"].as<int>(),
+        height = map["height"].as<int>();
+
+    std::vector<uint8_t> data(width * height);
+    val(typed_memory_view(data.size(), data.data())).call<void>("set", buffer);
+
+    return new Grid<uint8_t>(width, height, data);
 }
 
 EMSCRIPTEN_BINDINGS(rea_star) {    
@@ -25,13 +423,80 @@ EMSCRIPTEN_BINDINGS(rea_star) {
         .element(&Point::x)
         .element(&Point::y);
 
-    register_vector<Point>("PointArray");
-
     class_<Grid<bool>>("BooleanGrid")
-        .constructor<val>()
+        .constructor(&boolean_grid_from_map, allow_raw_pointers())
+        .constructor(&boolean_grid_from_buffer, allow_raw_pointers())
         .function("at", &Grid<bool>::operator[])
+        .function("set", &Grid<bool>::set)
+        .function("enterable", &Grid<bool>::enterable)
+        .function("walls", &Grid<bool>::walls)
+        .function("setWalls", &Grid<bool>::set_walls)
+        .function("invalidate", &Grid<bool>::invalidate)
+        .function("buildClearance", &Grid<bool>::build_clearance)
         .property("width", &Grid<bool>::width)
-        .property("height", &Grid<bool>::height);
+        .property("height", &Grid<bool>::height)
+        .property("loops", &Grid<bool>::loops);
+
+    class_<Grid<uint8_t>>("CostGrid")
+        .constructor(&cost_grid_from_buffer, allow_raw_pointers())
+        .function("at", &Grid<uint8_t>::operator[])
+        .function("set", &Grid<uint8_t>::set)
+        .property("width", &Grid<uint8_t>::width)
+        .property("height", &Grid<uint8_t>::height);
+
+    class_<REAStarSolver>("REAStarSearch")
+        .constructor<>()
+        .function("begin", &search_begin_js)
+        .function("step", &search_step_js)
+        .function("stepFor", &search_step_for_js)
+        .function("status", &search_status_js)
+        .function("path", &search_path_js);
+
+    class_<DistanceField>("DistanceField")
+        .constructor<>()
+        .function("path", &distance_field_path_js);
+
+    function(
+        "rectangleExpansionAStar",
+        rectangle_expansion_astar_js<DefaultPolicy>
+    );
+
+    function(
+        "rectangleExpansionAStarComplete",
+        rectangle_expansion_astar_js<CompletePolicy>
+    );
+
+    function(
+        "rectangleExpansionAStarGreedy",
+        rectangle_expansion_astar_js<GreedyPolicy>
+    );
+    function(
+        "rectangleExpansionAStarNearest",
+        rectangle_expansion_astar_nearest_js
+    );
+
+    function(
+        "weightedRectangleExpansionAStar",
+        weighted_rectangle_expansion_astar_js
+    );
+
+    function("hierarchicalAStar", hierarchical_astar_js);
+    function("jumpPointSearch", jump_point_search_js);
+    function("corridorRatio", &corridor_ratio);
+    function("gridAStar", grid_astar_js);
+    function("cachedPath", cached_path_js);
+
+    function("getLastSearchStats", last_search_stats_js);
+    function("getSearchHistogram", search_histogram_js);
+    function("resetSearchHistogram", reset_search_histogram_js);
+
+    function("pathBuffer", path_buffer_js);
+    function("rectangleExpansionAStarBatch", rectangle_expansion_astar_batch_js);
 
-    function("rectangleExpansionAStar", rectangle_expansion_astar_js);
+    function("rectangleExpansionAStarSubmit", rectangle_expansion_astar_submit_js);
+    function("rectangleExpansionAStarReady", rectangle_expansion_astar_ready_js);
+    function(
+        "rectangleExpansionAStarCollect",
+        rectangle_expansion_astar_collect_js
+    );
 }
@@ -0,0 +1,153 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "algorithm/rea_star.hpp"
+#include "data/grid.hpp"
+
+using namespace rea_star;
+
+namespace {
+    int failures = 0;
+
+    /**
+     * Counts a failed check and prints where it was made. Unlike `assert`,
+     * checks still run on release builds.
+     */
+    #define CHECK(condition) \
+        do { \
+            if (!(condition)) { \
+                failures++; \
+                std::printf("%s:%d: %s\n", __FILE__, __LINE__, #condition); \
+            } \
+        } while (false)
+
+    constexpr int SOUTH = Grid<bool>::wall(Cardinal::SOUTH);
+    constexpr int EAST = Grid<bool>::wall(Cardinal::EAST);
+
+    /**
+     * @return the byte for a cell on a passability buffer.
+     */
+    uint8_t cell(bool free, int walls = 0) {
+        return uint8_t(free) | walls << 1;
+    }
+
+    void test_buffer() {
+        // A ledge on the middle of a 3x3 map, which can't be left south.
+        std::vector<uint8_t> data(9, cell(true));
+        data[4] = cell(true, SOUTH);
+        data[0] = cell(false);
+
+        Grid<bool> g(3, 3, data);
+
+        Point corner = { .x = 0, .y = 0 },
+              ledge = { .x = 1, .y = 1 },
+              north = { .x = 1, .y = 0 },
+              south = { .x = 1, .y = 2 },
+              east = { .x = 2, .y = 1 };
+
+        CHECK(!g.enterable(corner));
+        CHECK(g.enterable(ledge));
+        CHECK(!g[ledge]);
+        CHECK(g.walls(ledge) == SOUTH);
+
+        CHECK(!g.passable(ledge, south));
+        CHECK(!g.passable(south, ledge));
+        CHECK(g.passable(ledge, north));
+        CHECK(g.passable(ledge, east));
+    }
+
+    void test_occupied_walls() {
+        // Tiles taken by characters are blocked on the buffer, but keep
+        // their walls for when they are freed.
+        std::vector<uint8_t> data(9, cell(true));
+        data[4] = cell(false, SOUTH);
+
+        Grid<bool> g(3, 3, data);
+
+        Point ledge = { .x = 1, .y = 1 },
+              north = { .x = 1, .y = 0 },
+              south = { .x = 1, .y = 2 };
+
+        CHECK(!g.enterable(ledge));
+        CHECK(g.walls(ledge) == SOUTH);
+
+        g.set(ledge, true);
+        CHECK(g.enterable(ledge));
+        CHECK(g.walls(ledge) == SOUTH);
+        CHECK(!g.passable(ledge, south));
+        CHECK(g.passable(ledge, north));
+
+        // Setting cells never touches their walls.
+        g.set(ledge, false);
+        g.set(ledge, true);
+        CHECK(g.walls(ledge) == SOUTH);
+        CHECK(!g.passable(ledge, south));
+    }
+
+    void test_occupied_walls_looping() {
+        std::vector<uint8_t> data(9, cell(true));
+        data[4] = cell(false, SOUTH);
+
+        Grid<bool> g(3, 3, data, nullptr, nullptr, Topology {
+            .loop_x = true,
+            .loop_y = true
+        });
+
+        g.set({ .x = 1, .y = 1 }, true);
+
+        // Every copy of the map keeps the ledge.
+        for (Point p : {
+            Point { .x = 1, .y = 1 },
+            Point { .x = 4, .y = 1 },
+            Point { .x = 1, .y = 4 },
+            Point { .x = 4, .y = 4 }
+        }) {
+            Point south = { .x = p.x, .y = p.y + 1 };
+
+            CHECK(g.enterable(p));
+            CHECK(g.walls(p) == SOUTH);
+            CHECK(!g.passable(p, south));
+        }
+    }
+
+    void test_freed_counter() {
+        // A counter splitting a one-tile corridor, taken by a character. Once
+        // it leaves, the corridor is still cut.
+        std::vector<uint8_t> data = {
+            cell(true), cell(false, EAST), cell(true)
+        };
+
+        Grid<bool> g(3, 1, data);
+
+        Point west = { .x = 0, .y = 0 },
+              counter = { .x = 1, .y = 0 },
+              east = { .x = 2, .y = 0 };
+
+        g.set(counter, true);
+
+        path_t path;
+        size_t points = rectangle_expansion_astar(west, east, g, path);
+        CHECK(points == 0 || path.back() != east);
+
+        // The corridor is still open up to the counter.
+        path.clear();
+        points = rectangle_expansion_astar(west, counter, g, path);
+        CHECK(points > 0 && path.back() == counter);
+    }
+};
+
+int main() {
+    test_buffer();
+    test_occupied_walls();
+    test_occupied_walls_looping();
+    test_freed_counter();
+
+    if (failures > 0) {
+        std::printf("%d checks failed\n", failures);
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,232 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "data/indexed_heap.hpp"
+
+using namespace rea_star;
+
+namespace {
+    int failures = 0;
+
+    /**
+     * Counts a failed check and prints where it was made. Unlike `assert`,
+     * checks still run on release builds.
+     */
+    #define CHECK(condition) \
+        do { \
+            if (!(condition)) { \
+                failures++; \
+                std::printf("%s:%d: %s\n", __FILE__, __LINE__, #condition); \
+            } \
+        } while (false)
+
+    /**
+     * Pops every key left on a heap.
+     * 
+     * @return the keys in the order they were popped.
+     */
+    template <typename H>
+    std::vector<uint32_t> drain(H& heap) {
+        std::vector<uint32_t> keys;
+        while (!heap.empty()) keys.push_back(heap.pop());
+
+        return keys;
+    }
+
+    void test_pop_order() {
+        IndexedHeap<int> heap;
+        heap.reset(8);
+
+        CHECK(heap.empty());
+
+        int priorities[] = { 5, 3, 7, 1, 6, 0, 4, 2 };
+        for (uint32_t key = 0; key < 8; key++) {
+            CHECK(heap.push(key, priorities[key]));
+        }
+
+        CHECK(heap.size() == 8);
+        CHECK(heap.top() == 5);
+        CHECK(heap.priority(2) == 7);
+
+        std::vector<uint32_t> expected = { 5, 3, 7, 1, 6, 0, 4, 2 };
+        CHECK(drain(heap) == expected);
+
+        for (uint32_t key = 0; key < 8; key++) CHECK(!heap.contains(key));
+    }
+
+    void test_decrease() {
+        IndexedHeap<int> heap;
+        heap.reset(4);
+
+        heap.push(0, 10);
+        heap.push(1, 20);
+        heap.push(2, 30);
+
+        // Pushing a key again only counts when it lowers its priority.
+        CHECK(!heap.push(2, 40));
+        CHECK(!heap.push(2, 30));
+        CHECK(heap.priority(2) == 30);
+        CHECK(heap.size() == 3);
+
+        CHECK(heap.push(2, 5));
+        CHECK(heap.priority(2) == 5);
+        CHECK(heap.size() == 3);
+        CHECK(heap.top() == 2);
+
+        // Updates move keys either way.
+        heap.update(2, 25);
+        CHECK(heap.top() == 0);
+        heap.update(1, 1);
+        CHECK(heap.top() == 1);
+
+        std::vector<uint32_t> expected = { 1, 0, 2 };
+        CHECK(drain(heap) == expected);
+
+        // Popped keys can be pushed again on the same generation.
+        CHECK(heap.push(0, 3));
+        CHECK(heap.contains(0));
+        CHECK(heap.pop() == 0);
+    }
+
+    void test_reset() {
+        IndexedHeap<int> heap;
+        heap.reset(4);
+
+        heap.push(0, 1);
+        heap.push(3, 2);
+
+        heap.reset(4);
+        CHECK(heap.empty());
+        CHECK(!heap.contains(0));
+        CHECK(!heap.contains(3));
+
+        // Keys left over from the last generation are pushed anew.
+        CHECK(heap.push(3, 9));
+        CHECK(heap.priority(3) == 9);
+        CHECK(heap.size() == 1);
+
+        // Growing the key range keeps the heap empty.
+        heap.reset(16);
+        CHECK(heap.empty());
+        CHECK(!heap.contains(3));
+
+        heap.push(15, 4);
+        heap.push(3, 8);
+        std::vector<uint32_t> expected = { 15, 3 };
+        CHECK(drain(heap) == expected);
+
+        // Shrinking it keeps the memory, and the old keys stay cleared.
+        heap.reset(2);
+        CHECK(!heap.contains(15));
+    }
+
+    void test_generation_wrap() {
+        // Stamps of 8 bits wrap around after 255 resets, when stale ones
+        // would otherwise read as current again.
+        IndexedHeap<int, uint8_t> heap;
+
+        for (int round = 0; round < 600; round++) {
+            heap.reset(4);
+
+            bool stale = false;
+            for (uint32_t key = 0; key < 4; key++) {
+                stale = stale || heap.contains(key);
+            }
+
+            CHECK(!stale);
+            if (stale) break;
+
+            // Keys pushed on the first generations keep their stamps until
+            // the generation comes back around.
+            if (round < 4) heap.push(round, round);
+        }
+    }
+
+    void test_random() {
+        constexpr uint32_t KEYS = 256;
+
+        std::mt19937 rng(1);
+        auto random = [&rng](int limit) {
+            return std::uniform_int_distribution<int>(0, limit - 1)(rng);
+        };
+
+        IndexedHeap<int> heap;
+        for (int round = 0; round < 20; round++) {
+            heap.reset(KEYS);
+
+            // Priority of each key on the heap, or -1 if not on it.
+            std::vector<int> expected(KEYS, -1);
+
+            for (int step = 0; step < 2000; step++) {
+                uint32_t key = random(KEYS);
+                int priority = random(1000);
+
+                switch (random(3)) {
+                    case 0: {
+                        bool lower = expected[key] < 0
+                            || priority < expected[key];
+
+                        CHECK(heap.push(key, priority) == lower);
+                        if (lower) expected[key] = priority;
+                        break;
+                    }
+
+                    case 1:
+                        if (expected[key] < 0) break;
+
+                        heap.update(key, priority);
+                        expected[key] = priority;
+                        break;
+
+                    default: {
+                        if (heap.empty()) break;
+
+                        int lowest = *std::min_element(
+                            expected.begin(),
+                            expected.end(),
+                            [](int a, int b) {
+                                return (a >= 0 ? a : INT32_MAX)
+                                    < (b >= 0 ? b : INT32_MAX);
+                            }
+                        );
+
+                        uint32_t top = heap.pop();
+                        CHECK(expected[top] == lowest);
+                        expected[top] = -1;
+                        break;
+                    }
+                }
+
+                CHECK(heap.size() == size_t(KEYS - std::count(
+                    expected.begin(), expected.end(), -1
+                )));
+            }
+
+            for (uint32_t key = 0; key < KEYS; key++) {
+                CHECK(heap.contains(key) == (expected[key] >= 0));
+                if (expected[key] >= 0) {
+                    CHECK(heap.priority(key) == expected[key]);
+                }
+            }
+        }
+    }
+};
+
+int main() {
+    test_pop_order();
+    test_decrease();
+    test_reset();
+    test_generation_wrap();
+    test_random();
+
+    if (failures > 0) {
+        std::printf("%d checks failed\n", failures);
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}